@@ -0,0 +1,52 @@
+#ifndef ALGO_ALTERNATION_HPP
+#define ALGO_ALTERNATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BondProductRepository.hpp"
+
+// How the algo services alternate (buy/sell in AlgoExecution, 1mm/2mm in
+// AlgoStreaming) and number their orders.
+enum class AlgoAlternation : std::uint8_t {
+  kGlobal,      // one toggle and one counter across all products (the project spec)
+  kPerProduct,  // one of each per product, so a product's output does not depend on
+                // the others; sharded mode needs this, as no shard sees every product
+};
+
+// The toggle and order counter of one algo service, in either mode.
+class AlgoAlternationState {
+ public:
+  explicit AlgoAlternationState(AlgoAlternation mode)
+      : per_product_(mode == AlgoAlternation::kPerProduct),
+        toggles_(per_product_ ? BondProductRepository::Instance().Size() : 1, true),
+        seqs_(toggles_.size(), 1) {}
+
+  // true, false, true, ... for product idx (or for all products).
+  bool Toggle(std::size_t idx) {
+    const std::size_t slot = Slot(idx);
+    const bool value = toggles_[slot];
+    toggles_[slot] = !value;
+    return value;
+  }
+
+  // 1, 2, 3, ... for product idx (or for all products).
+  long NextSeq(std::size_t idx) { return seqs_[Slot(idx)]++; }
+
+ private:
+  std::size_t Slot(std::size_t idx) {
+    if (!per_product_) return 0;
+    if (idx >= toggles_.size()) {
+      toggles_.resize(idx + 1, true);
+      seqs_.resize(idx + 1, 1);
+    }
+    return idx;
+  }
+
+  bool per_product_;
+  std::vector<bool> toggles_;
+  std::vector<long> seqs_;
+};
+
+#endif
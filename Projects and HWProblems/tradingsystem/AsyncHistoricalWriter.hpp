@@ -0,0 +1,185 @@
+#ifndef ASYNC_HISTORICAL_WRITER_HPP
+#define ASYNC_HISTORICAL_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "MpscQueue.hpp"
+#include "TextBuffer.hpp"
+
+// Asynchronous backend for the historical file writers. Callers format a record as
+// before and Append() it; the bytes are copied into a bounded MPSC queue and the
+// writer thread appends them to a per-file batch. A batch is written (one write and
+// flush) once it reaches flush_bytes or once it has waited flush_interval, so the
+// service threads never touch the file. The destructor writes out everything still
+// queued or batched.
+enum class AsyncOverflow : std::uint8_t {
+  kBlock,  // wait for room (no loss; a stalled disk stalls the callers)
+  kDrop,   // drop the record and count it
+};
+
+struct AsyncWriterOptions {
+  std::size_t queue_capacity = 16384;  // records
+  std::size_t flush_bytes = 64 * 1024;
+  std::chrono::milliseconds flush_interval{50};
+  AsyncOverflow overflow = AsyncOverflow::kBlock;
+  std::chrono::milliseconds report_interval{5000};  // 0 = never
+};
+
+class AsyncHistoricalWriter {
+ public:
+  // Bytes carried by one queue record. Longer appends are split at line ends.
+  static constexpr std::size_t kRecordBytes = 240;
+
+  class File;
+
+  explicit AsyncHistoricalWriter(AsyncWriterOptions options = AsyncWriterOptions())
+      : options_(options), queue_(options.queue_capacity), thread_([this] { Run(); }) {}
+
+  AsyncHistoricalWriter(const AsyncHistoricalWriter&) = delete;
+  AsyncHistoricalWriter& operator=(const AsyncHistoricalWriter&) = delete;
+
+  // Drains the queue, writes every batch and stops the writer thread.
+  ~AsyncHistoricalWriter() {
+    stop_.store(true, std::memory_order_release);
+    thread_.join();
+    PrintStats(std::cerr << "[AsyncWriter] ");
+    std::cerr << "\n";
+  }
+
+  // Opens (truncates) filename. The File lives as long as the writer.
+  File& Open(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    files_.emplace_back(filename);
+    if (!files_.back().out.is_open()) throw std::runtime_error("Unable to open " + filename);
+    return files_.back();
+  }
+
+  // Any thread. bytes should be whole lines.
+  void Append(File& file, std::string_view bytes) {
+    while (bytes.size() > kRecordBytes) {
+      std::size_t cut = bytes.rfind('\n', kRecordBytes - 1);
+      cut = cut == std::string_view::npos ? kRecordBytes : cut + 1;
+      Enqueue(file, bytes.substr(0, cut));
+      bytes.remove_prefix(cut);
+    }
+    if (!bytes.empty()) Enqueue(file, bytes);
+  }
+
+  std::size_t Depth() const { return queue_.Depth(); }
+  std::size_t HighWater() const { return queue_.HighWater(); }
+  std::uint64_t Drops() const { return drops_.load(std::memory_order_relaxed); }
+  std::uint64_t Batches() const { return batches_.load(std::memory_order_relaxed); }
+  std::uint64_t BytesWritten() const { return bytes_.load(std::memory_order_relaxed); }
+
+  // "records=.. depth=.. max=.. drops=.. batches=.. bytes=.."
+  std::ostream& PrintStats(std::ostream& os) const {
+    os << "records=" << queue_.Popped() << " depth=" << Depth() << " max=" << HighWater() << " drops=" << Drops()
+       << " batches=" << Batches() << " bytes=" << BytesWritten();
+    if (queue_.FullWaits()) os << " full_waits=" << queue_.FullWaits();
+    return os;
+  }
+
+  class File {
+   public:
+    explicit File(const std::string& filename) : out(filename, std::ios::out), batch(64 * 1024) {}
+
+   private:
+    friend class AsyncHistoricalWriter;
+    std::ofstream out;
+    TextBuffer batch;  // writer thread only
+    std::chrono::steady_clock::time_point first_pending{};
+  };
+
+ private:
+  struct Record {
+    Record(File& f, std::string_view bytes) : file(&f), len(static_cast<std::uint16_t>(bytes.size())) {
+      std::memcpy(data, bytes.data(), bytes.size());
+    }
+    File* file;
+    std::uint16_t len;
+    char data[kRecordBytes];
+  };
+
+  void Enqueue(File& file, std::string_view bytes) {
+    if (options_.overflow == AsyncOverflow::kBlock) {
+      queue_.Push(file, bytes);
+    } else if (!queue_.TryPush(file, bytes)) {
+      drops_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void Run() {
+    using Clock = std::chrono::steady_clock;
+    auto next_report = Clock::now() + options_.report_interval;
+    std::uint64_t reported = 0;
+    for (;;) {
+      const bool stopping = stop_.load(std::memory_order_acquire);
+      std::size_t n = 0;
+      while (n < options_.queue_capacity && queue_.Consume([this](Record& r) { Batch(r); })) ++n;
+
+      const auto now = Clock::now();
+      if (stopping) {
+        FlushDue(now, /*all=*/true);
+        return;
+      }
+      FlushDue(now, /*all=*/false);
+
+      if (options_.report_interval.count() > 0 && now >= next_report) {
+        next_report = now + options_.report_interval;
+        if (queue_.Popped() != reported) {
+          reported = queue_.Popped();
+          PrintStats(std::cerr << "[AsyncWriter] ");
+          std::cerr << "\n";
+        }
+      }
+      if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  void Batch(Record& r) {
+    File& f = *r.file;
+    if (f.batch.Size() == 0) f.first_pending = std::chrono::steady_clock::now();
+    f.batch.Append(std::string_view(r.data, r.len));
+    if (f.batch.Size() >= options_.flush_bytes) Flush(f);
+  }
+
+  void FlushDue(std::chrono::steady_clock::time_point now, bool all) {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    for (File& f : files_) {
+      if (f.batch.Size() && (all || now - f.first_pending >= options_.flush_interval)) Flush(f);
+    }
+  }
+
+  void Flush(File& f) {
+    f.out.write(f.batch.Data(), static_cast<std::streamsize>(f.batch.Size()));
+    f.out.flush();
+    bytes_.fetch_add(f.batch.Size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    f.batch.Clear();
+  }
+
+  AsyncWriterOptions options_;
+  MpscQueue<Record> queue_;
+  std::mutex files_mutex_;  // Open vs. the writer's walk over files_ (not per record)
+  std::deque<File> files_;  // stable addresses
+  std::atomic<bool> stop_{false};
+  std::atomic<std::uint64_t> drops_{0};
+  std::atomic<std::uint64_t> batches_{0};
+  std::atomic<std::uint64_t> bytes_{0};
+  std::thread thread_;  // last: starts once everything above is built
+};
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef ASYNC_TCP_OUTBOUND_CONNECTOR_HPP
+#define ASYNC_TCP_OUTBOUND_CONNECTOR_HPP
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ProductTable.hpp"
+#include "ShmStringRingBuffer.hpp"  // SpinBackoff
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
+#include "soa.hpp"
+
+// Outbound TCP publisher that keeps the socket off the service threads. Publish()
+// serializes the record and copies it into a bounded ring of pending lines; an I/O
+// thread takes everything pending, writes it to the peer in one call and measures
+// how long each line waited (enqueue to write).
+//
+// The connection is retried every reconnect_interval while no peer is connected
+// (the printer is not up yet, or went away). Under kBlock the pending lines stay
+// in the ring until a peer connects, so a missing peer stalls the publisher like a
+// slow one. Under the other policies the I/O thread discards them and counts them
+// as unsent. Only the batch being written when a peer drops is lost under kBlock.
+// At shutdown, lines no peer took are counted as unsent.
+enum class OutboundOverflow : std::uint8_t {
+  kBlock,       // wait for room (no loss; a stalled or missing peer stalls the publisher)
+  kDropOldest,  // discard the oldest pending line
+  kConflate,    // keep only the newest pending line per product; else drop oldest
+};
+
+struct OutboundOptions {
+  std::size_t capacity = 4096;  // pending lines
+  OutboundOverflow overflow = OutboundOverflow::kBlock;
+  std::size_t batch_bytes = 64 * 1024;  // most taken per write
+  std::chrono::milliseconds reconnect_interval{1000};
+  std::chrono::milliseconds report_interval{5000};  // 0 = never
+};
+
+template <typename V>
+class AsyncTcpOutboundConnector : public Connector<V> {
+ public:
+  // serializer: SerializeXxxTo-style function appending one line (no newline).
+  using Serializer = std::function<void(const V&, TextBuffer&)>;
+
+  // Longest line (with newline) a ring slot holds.
+  static constexpr std::size_t kLineBytes = 240;
+
+  AsyncTcpOutboundConnector(const std::string& host, int port, Serializer serializer,
+                            OutboundOptions options = OutboundOptions())
+      : host_(host),
+        port_(port),
+        serializer_(std::move(serializer)),
+        options_(options),
+        ring_(options.capacity ? options.capacity : 1),
+        pending_by_product_(BondProductRepository::Instance().Size(), 0),
+        thread_([this] { Run(); }) {}
+
+  AsyncTcpOutboundConnector(const AsyncTcpOutboundConnector&) = delete;
+  AsyncTcpOutboundConnector& operator=(const AsyncTcpOutboundConnector&) = delete;
+
+  // Sends (or, if disconnected, discards) whatever is pending, then stops.
+  // Call StopWaiting() first if publishers may still be blocked.
+  ~AsyncTcpOutboundConnector() {
+    stop_.store(true, std::memory_order_release);
+    thread_.join();
+    PrintStats(std::cerr << "[Outbound:" << port_ << "] ");
+    std::cerr << "\n";
+  }
+
+  // Any service thread. No socket calls: a short lock and a copy.
+  void Publish(V& data) override {
+    static thread_local TextBuffer line;
+    line.Clear();
+    serializer_(data, line);
+    line.Append('\n');
+    if (line.Size() > kLineBytes) throw std::length_error("Outbound line too long: " + line.Str());
+    Enqueue(line.View(), ProductIndexOf(data.GetProduct()));
+  }
+
+  bool Connected() const { return connected_.load(std::memory_order_relaxed); }
+
+  // For shutdown under kBlock: from now on a publisher does not wait for a peer
+  // that is not connected. If the ring is full it discards the oldest line (counted
+  // as unsent), so stopping the publishing threads cannot hang on a printer that is
+  // down. A connected peer is still waited for.
+  void StopWaiting() { stop_waiting_.store(true, std::memory_order_release); }
+
+  std::size_t Depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<std::size_t>(tail_ - head_);
+  }
+
+  // "sent=.. dropped=.. conflated=.. unsent=.. depth=.. max=.. lag_avg_us=.. lag_max_us=.."
+  std::ostream& PrintStats(std::ostream& os) const {
+    const std::uint64_t sent = sent_.load(std::memory_order_relaxed);
+    const std::int64_t lag_sum = lag_sum_ns_.load(std::memory_order_relaxed);
+    os << "sent=" << sent << " dropped=" << dropped_.load(std::memory_order_relaxed)
+       << " conflated=" << conflated_.load(std::memory_order_relaxed)
+       << " unsent=" << unsent_.load(std::memory_order_relaxed) << " depth=" << Depth()
+       << " max=" << high_water_.load(std::memory_order_relaxed)
+       << " lag_avg_us=" << (sent ? lag_sum / static_cast<std::int64_t>(sent) / 1000 : 0)
+       << " lag_max_us=" << lag_max_ns_.load(std::memory_order_relaxed) / 1000;
+    if (full_waits_.load(std::memory_order_relaxed)) os << " full_waits=" << full_waits_.load(std::memory_order_relaxed);
+    return os;
+  }
+
+ private:
+  struct Slot {
+    std::int64_t enqueued_ns;
+    std::uint32_t product;
+    std::uint16_t len;
+    char data[kLineBytes];
+  };
+
+  void Enqueue(std::string_view bytes, std::size_t product) {
+    const std::int64_t now = TimestampNs();
+    SpinBackoff backoff;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (options_.overflow == OutboundOverflow::kConflate) {
+      // Still pending (not taken or dropped since)? Replace it where it stands.
+      const std::uint64_t at = pending_by_product_[product];
+      if (at > head_) {
+        Fill(ring_[(at - 1) % ring_.size()], bytes, product, ring_[(at - 1) % ring_.size()].enqueued_ns);
+        conflated_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+
+    while (tail_ - head_ == ring_.size()) {
+      if (options_.overflow != OutboundOverflow::kBlock) {
+        ++head_;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+      if (!Connected() && stop_waiting_.load(std::memory_order_acquire)) {
+        ++head_;
+        unsent_.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+      full_waits_.fetch_add(1, std::memory_order_relaxed);
+      lock.unlock();
+      backoff.Pause();
+      lock.lock();
+    }
+
+    Fill(ring_[tail_ % ring_.size()], bytes, product, now);
+    pending_by_product_[product] = ++tail_;
+    const std::size_t depth = static_cast<std::size_t>(tail_ - head_);
+    if (depth > high_water_.load(std::memory_order_relaxed)) high_water_.store(depth, std::memory_order_relaxed);
+  }
+
+  static void Fill(Slot& s, std::string_view bytes, std::size_t product, std::int64_t enqueued_ns) {
+    s.enqueued_ns = enqueued_ns;
+    s.product = static_cast<std::uint32_t>(product);
+    s.len = static_cast<std::uint16_t>(bytes.size());
+    std::memcpy(s.data, bytes.data(), bytes.size());
+  }
+
+  // Moves pending lines into batch_ (up to batch_bytes). Returns how many.
+  std::size_t Take() {
+    batch_.Clear();
+    std::size_t n = 0;
+    const std::int64_t now = TimestampClock::NowNs();
+    std::int64_t lag_sum = 0, lag_max = lag_max_ns_.load(std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (head_ != tail_ && batch_.Size() < options_.batch_bytes) {
+        const Slot& s = ring_[head_++ % ring_.size()];
+        batch_.Append(std::string_view(s.data, s.len));
+        const std::int64_t lag = now - s.enqueued_ns;
+        lag_sum += lag;
+        if (lag > lag_max) lag_max = lag;
+        ++n;
+      }
+    }
+    if (n && Connected()) {
+      lag_sum_ns_.fetch_add(lag_sum, std::memory_order_relaxed);
+      lag_max_ns_.store(lag_max, std::memory_order_relaxed);
+    }
+    return n;
+  }
+
+  void Run() {
+    using Clock = std::chrono::steady_clock;
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket socket(io);
+    auto next_connect = Clock::now();
+    auto next_report = Clock::now() + options_.report_interval;
+    std::uint64_t reported = 0;
+    bool warned = false;  // about held or discarded lines, since the last connect
+    bool warned_stopping = false;
+
+    for (;;) {
+      const bool stopping = stop_.load(std::memory_order_acquire);
+      const auto now = Clock::now();
+      if (!Connected() && now >= next_connect && !stopping) {
+        next_connect = now + options_.reconnect_interval;
+        if (TryConnect(io, socket)) warned = false;
+      }
+
+      // kBlock without a peer: leave the lines pending until one connects.
+      if (!Connected() && !stopping && options_.overflow == OutboundOverflow::kBlock) {
+        if (!warned && Depth() > 0) {
+          std::cerr << "[Outbound:" << port_ << "] no peer: holding lines until one connects; "
+                    << "publishers block when " << ring_.size() << " are pending\n";
+          warned = true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        continue;
+      }
+
+      const std::size_t n = Take();
+      if (n && Connected()) {
+        boost::system::error_code ec;
+        boost::asio::write(socket, boost::asio::buffer(batch_.Data(), batch_.Size()), ec);
+        if (ec) {
+          std::cerr << "[Outbound:" << port_ << "] disconnected: " << ec.message() << "\n";
+          socket.close();
+          connected_.store(false, std::memory_order_relaxed);
+          unsent_.fetch_add(n, std::memory_order_relaxed);
+        } else {
+          sent_.fetch_add(n, std::memory_order_relaxed);
+        }
+      } else if (n) {
+        if (!warned || (stopping && !warned_stopping)) {
+          std::cerr << "[Outbound:" << port_ << "] no peer" << (stopping ? " at shutdown" : "")
+                    << ": discarding pending lines (counted as unsent)\n";
+          warned = warned_stopping = true;
+        }
+        unsent_.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      if (stopping && n == 0) return;
+
+      if (options_.report_interval.count() > 0 && now >= next_report) {
+        next_report = now + options_.report_interval;
+        if (sent_.load(std::memory_order_relaxed) != reported) {
+          reported = sent_.load(std::memory_order_relaxed);
+          PrintStats(std::cerr << "[Outbound:" << port_ << "] ");
+          std::cerr << "\n";
+        }
+      }
+      if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  bool TryConnect(boost::asio::io_context& io, boost::asio::ip::tcp::socket& socket) {
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::resolver resolver(io);
+    const auto endpoints = resolver.resolve(host_, std::to_string(port_), ec);
+    if (!ec) boost::asio::connect(socket, endpoints, ec);
+    if (ec) {
+      if (socket.is_open()) socket.close();
+      return false;
+    }
+    socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    connected_.store(true, std::memory_order_relaxed);
+    std::cerr << "[Outbound:" << port_ << "] connected to " << host_ << ":" << port_ << "\n";
+    return true;
+  }
+
+  std::string host_;
+  int port_;
+  Serializer serializer_;
+  OutboundOptions options_;
+
+  mutable std::mutex mutex_;  // guards the ring, head_, tail_, pending_by_product_
+  std::vector<Slot> ring_;
+  std::uint64_t head_ = 0;  // next line to take
+  std::uint64_t tail_ = 0;  // next free position
+  std::vector<std::uint64_t> pending_by_product_;  // position + 1 of the product's last line
+
+  TextBuffer batch_{64 * 1024};  // I/O thread only
+  std::atomic<bool> connected_{false};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> stop_waiting_{false};
+  std::atomic<std::uint64_t> sent_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> conflated_{0};
+  std::atomic<std::uint64_t> unsent_{0};
+  std::atomic<std::uint64_t> full_waits_{0};
+  std::atomic<std::size_t> high_water_{0};
+  std::atomic<std::int64_t> lag_sum_ns_{0};
+  std::atomic<std::int64_t> lag_max_ns_{0};
+  std::thread thread_;  // last: starts once everything above is built
+};
+
+#endif
@@ -1,10 +1,13 @@
 #ifndef BOND_ALGO_EXECUTION_SERVICE_HPP
 #define BOND_ALGO_EXECUTION_SERVICE_HPP
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "AlgoAlternation.hpp"
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "executionservice.hpp"
 #include "marketdataservice.hpp"
 #include "products.hpp"
@@ -19,65 +22,78 @@ private:
     ExecutionOrder<Bond> order_;
 };
 
-class BondAlgoExecutionService final : public Service<std::string, AlgoExecution>,
-                                      public ServiceListener<OrderBook<Bond>> 
+// Listeners: DynamicListeners<AlgoExecution> or StaticListeners<AlgoExecution, ...> (soa.hpp).
+// alternation: one buy/sell toggle and order counter for all products (default), or
+// one per product (sharded mode).
+template <typename Listeners = DynamicListeners<AlgoExecution>>
+class BasicBondAlgoExecutionService final : public Service<std::string, AlgoExecution>,
+                                           public OrderBookListener<Bond>
 {
 public:
-    BondAlgoExecutionService() = default;
+    explicit BasicBondAlgoExecutionService(Listeners listeners = Listeners(),
+                                           AlgoAlternation alternation = AlgoAlternation::kGlobal)
+        : listeners_(std::move(listeners)), alternation_(alternation) {}
 
-    AlgoExecution& GetData(std::string key) override { return algo_execs_.at(key); }
+    AlgoExecution& GetData(std::string key) override { return algo_execs_.At(key); }
 
     void OnMessage(AlgoExecution& data) override 
     {
-        const std::string pid = data.GetOrder().GetProduct().GetProductId();
-        algo_execs_.erase(pid);
-        algo_execs_.emplace(pid, AlgoExecution(data.GetOrder()));
+        AlgoExecution& stored = algo_execs_.Emplace(ProductIndexOf(data.GetOrder().GetProduct()), data.GetOrder());
 
-        for (auto* l : listeners_) l->ProcessUpdate(algo_execs_.at(pid));
+        listeners_.ForEach([&](auto& l) { l.ProcessUpdate(stored); });
     }
 
     void AddListener(ServiceListener<AlgoExecution>* listener) override 
     {
-        listeners_.push_back(listener);
+        listeners_.Add(listener);
     }
 
     const std::vector<ServiceListener<AlgoExecution>*>& GetListeners() const override 
     {
-        return listeners_;
+        return listeners_.Get();
     }
 
     // Listen to BondMarketDataService
     void ProcessAdd(OrderBook<Bond>& book) override { ProcessUpdate(book); }
     void ProcessRemove(OrderBook<Bond>&) override {}
 
+    // Incremental update: decided exactly as a snapshot of the same book would be
+    // (every book flips the side toggle), so executions do not depend on the wire
+    // format.
+    void ProcessChange(OrderBook<Bond>& book, const BookChange&) override
+    {
+        ProcessUpdate(book);
+    }
+
     void ProcessUpdate(OrderBook<Bond>& book) override 
     {
-        // Only aggress when spread is tightest: 1/128 = 0.0078125 in decimal.
+        RecordLatency(LatencyStage::kAlgoExecution);
+        // Only aggress when spread is tightest: 1/128 = 2 ticks of 1/256.
         const auto& bids = book.GetBidStack();
         const auto& offers = book.GetOfferStack();
         if (bids.empty() || offers.empty()) return;
 
-        const double bid_px = bids.front().GetPrice();
-        const double offer_px = offers.front().GetPrice();
-        const double spread = offer_px - bid_px;
+        const PriceTicks bid_px = bids.front().GetPrice();
+        const PriceTicks offer_px = offers.front().GetPrice();
+        const PriceTicks spread = offer_px - bid_px;
 
-        constexpr double kTightSpread = 1.0 / 128.0;
-        if (std::abs(spread - kTightSpread) > 1e-12) return;
+        constexpr PriceTicks kTightSpread(2);
+        if (spread != kTightSpread) return;
 
-        const std::string pid = book.GetProduct().GetProductId();
+        const std::string& pid = book.GetProduct().GetProductId();
+        const std::size_t idx = ProductIndexOf(book.GetProduct());
 
         // Alternate between taking offer (buy) and taking bid (sell)
-        const bool buy = next_buy_;
-        next_buy_ = !next_buy_;
+        const bool buy = alternation_.Toggle(idx);
 
         const PricingSide side = buy ? OFFER : BID;  // if buy, we aggress OFFER; if sell, aggress BID
-        const double px = buy ? offer_px : bid_px;
+        const PriceTicks px = buy ? offer_px : bid_px;
         const long qty = buy ? offers.front().GetQuantity() : bids.front().GetQuantity();
 
         // Visible = full size, hidden = 0 for execution in this project spec.
         ExecutionOrder<Bond> order(book.GetProduct(),
                                 side,
-                                "EXE_" + pid + "_" + std::to_string(seq_++),
+                                "EXE_" + pid + "_" + std::to_string(alternation_.NextSeq(idx)),
                                 MARKET,
                                 px,
                                 qty,
@@ -85,20 +101,16 @@ public:
                                 "",
                                 false);
 
-        AlgoExecution algo(order);
-        algo_execs_.erase(pid);
-        algo_execs_.emplace(pid, AlgoExecution(algo.GetOrder()));
-
-
-        AlgoExecution& stored = algo_execs_.at(pid);
-        for (auto* l : listeners_) l->ProcessAdd(stored);
+        AlgoExecution& stored = algo_execs_.Emplace(idx, order);
+        listeners_.ForEach([&](auto& l) { l.ProcessAdd(stored); });
     }
 
 private:
-    std::map<std::string, AlgoExecution> algo_execs_;
-    std::vector<ServiceListener<AlgoExecution>*> listeners_;
-    bool next_buy_ = true;
-    long seq_ = 1;
+    ProductTable<AlgoExecution> algo_execs_;
+    Listeners listeners_;
+    AlgoAlternationState alternation_;
 };
 
+using BondAlgoExecutionService = BasicBondAlgoExecutionService<>;
+
 #endif
@@ -1,10 +1,12 @@
 #ifndef BOND_ALGO_STREAMING_SERVICE_HPP
 #define BOND_ALGO_STREAMING_SERVICE_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
+#include "AlgoAlternation.hpp"
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "pricingservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
@@ -20,20 +22,21 @@ class AlgoStream
         PriceStream<Bond> stream_;
 };
 
+// alternation: one 1mm/2mm size toggle for all products (default), or one per
+// product (sharded mode).
 class BondAlgoStreamingService final : public Service<std::string, AlgoStream>,
                                       public ServiceListener<Price<Bond>> {
 public:
-    BondAlgoStreamingService() = default;
+    explicit BondAlgoStreamingService(AlgoAlternation alternation = AlgoAlternation::kGlobal)
+        : alternation_(alternation) {}
 
-    AlgoStream& GetData(std::string key) override { return streams_.at(key); }
+    AlgoStream& GetData(std::string key) override { return streams_.At(key); }
 
     void OnMessage(AlgoStream& data) override 
     {
-        const std::string pid = data.GetPriceStream().GetProduct().GetProductId();
-        streams_.erase(pid);
-        streams_.emplace(pid, AlgoStream(data.GetPriceStream()));
+        AlgoStream& stored = streams_.Emplace(ProductIndexOf(data.GetPriceStream().GetProduct()), data.GetPriceStream());
 
-        for (auto* l : listeners_) l->ProcessUpdate(streams_.at(pid));
+        for (auto* l : listeners_) l->ProcessUpdate(stored);
     }
 
     void AddListener(ServiceListener<AlgoStream>* listener) override 
@@ -52,34 +55,29 @@ public:
 
     void ProcessUpdate(Price<Bond>& p) override 
     {
-        const std::string pid = p.GetProduct().GetProductId();
-
-        const double mid = p.GetMid();
-        const double spr = p.GetBidOfferSpread();
-        const double bid = mid - spr / 2.0;
-        const double offer = mid + spr / 2.0;
-
-        const long visible = (toggle_ ? 1'000'000L : 2'000'000L);
-        toggle_ = !toggle_;
+        RecordLatency(LatencyStage::kAlgoStreaming);
+        // Split the spread on the tick grid; an odd tick goes to the offer side.
+        const PriceTicks mid = p.GetMid();
+        const PriceTicks spr = p.GetBidOfferSpread();
+        const PriceTicks bid = mid - PriceTicks(spr.Ticks() / 2);
+        const PriceTicks offer = bid + spr;
+
+        const std::size_t idx = ProductIndexOf(p.GetProduct());
+        const long visible = (alternation_.Toggle(idx) ? 1'000'000L : 2'000'000L);
         const long hidden = 2 * visible;
 
         PriceStreamOrder bid_order(bid, visible, hidden, BID);
         PriceStreamOrder offer_order(offer, visible, hidden, OFFER);
         PriceStream<Bond> ps(p.GetProduct(), bid_order, offer_order);
 
-        AlgoStream as(ps);
-        streams_.erase(pid);
-        streams_.emplace(pid, AlgoStream(as.GetPriceStream()));
-
-
-        AlgoStream& stored = streams_.at(pid);
+        AlgoStream& stored = streams_.Emplace(idx, ps);
         for (auto* l : listeners_) l->ProcessAdd(stored);
     }
 
 private:
-    std::map<std::string, AlgoStream> streams_;
+    ProductTable<AlgoStream> streams_;
     std::vector<ServiceListener<AlgoStream>*> listeners_;
-    bool toggle_ = true;
+    AlgoAlternationState alternation_;  // visible size alternates 1mm/2mm
 };
 
 #endif
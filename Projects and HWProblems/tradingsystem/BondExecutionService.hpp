@@ -1,25 +1,29 @@
 #ifndef BOND_EXECUTION_SERVICE_HPP
 #define BOND_EXECUTION_SERVICE_HPP
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "executionservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
 #include "tradebookingservice.hpp"
 
-class BondExecutionService final : public ExecutionService<Bond> {
+// Listeners: DynamicListeners<ExecutionOrder<Bond>> or StaticListeners<ExecutionOrder<Bond>, ...> (soa.hpp).
+template <typename Listeners = DynamicListeners<ExecutionOrder<Bond>>>
+class BasicBondExecutionService final : public ExecutionService<Bond> {
 public:
-    BondExecutionService() = default;
+    explicit BasicBondExecutionService(Listeners listeners = Listeners()) : listeners_(std::move(listeners)) {}
 
     void SetPublishConnector(Connector<ExecutionOrder<Bond>>* connector) 
     {
         pub_connector_ = connector;
     }
 
-    ExecutionOrder<Bond>& GetData(std::string key) override { return execs_.at(key); }
+    ExecutionOrder<Bond>& GetData(std::string key) override { return execs_.At(key); }
 
     void OnMessage(ExecutionOrder<Bond>&) override 
     {
@@ -28,40 +32,40 @@ public:
 
     void AddListener(ServiceListener<ExecutionOrder<Bond>>* listener) override 
     {
-        listeners_.push_back(listener);
+        listeners_.Add(listener);
     }
 
     const std::vector<ServiceListener<ExecutionOrder<Bond>>*>& GetListeners() const override 
     {
-        return listeners_;
+        return listeners_.Get();
     }
 
     void ExecuteOrder(const ExecutionOrder<Bond>& order, Market market) override 
     {
+        RecordLatency(LatencyStage::kExecution);
         (void)market;  // Your implementation may route by market.
-        const std::string pid = order.GetProduct().GetProductId();
-        execs_.erase(pid);
-        execs_.emplace(pid, ExecutionOrder<Bond>(order.GetProduct(),
-                                                order.GetSide(),
-                                                order.GetOrderId(),
-                                                order.GetOrderType(),
-                                                order.GetPrice(),
-                                                order.GetVisibleQuantity(),
-                                                order.GetHiddenQuantity(),
-                                                order.GetParentOrderId(),
-                                                order.IsChildOrder()));
-
-
-        ExecutionOrder<Bond>& stored = execs_.at(pid);
-        for (auto* l : listeners_) l->ProcessAdd(stored);
+        ExecutionOrder<Bond>& stored = execs_.Emplace(ProductIndexOf(order.GetProduct()),
+                                                      order.GetProduct(),
+                                                      order.GetSide(),
+                                                      order.GetOrderId(),
+                                                      order.GetOrderType(),
+                                                      order.GetPrice(),
+                                                      order.GetVisibleQuantity(),
+                                                      order.GetHiddenQuantity(),
+                                                      order.GetParentOrderId(),
+                                                      order.IsChildOrder());
+        listeners_.ForEach([&](auto& l) { l.ProcessAdd(stored); });
 
+        RecordLatency(LatencyStage::kExecutionOut);
         if (pub_connector_) pub_connector_->Publish(stored);
     }
 
 private:
-    std::map<std::string, ExecutionOrder<Bond>> execs_;
-    std::vector<ServiceListener<ExecutionOrder<Bond>>*> listeners_;
+    ProductTable<ExecutionOrder<Bond>> execs_;
+    Listeners listeners_;
     Connector<ExecutionOrder<Bond>>* pub_connector_ = nullptr;
 };
 
+using BondExecutionService = BasicBondExecutionService<>;
+
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define BOND_HISTORICAL_DATA_SERVICE_HPP
 
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -18,6 +19,9 @@
 // File-based historical connectors (PositionFileConnector, RiskFileConnector, etc.)
 #include "HistoricalWriters.hpp"
 
+// Binary journal connector (JournalConnector)
+#include "HistoricalJournal.hpp"
+
 // -----------------------------------------------------------------------------
 // Listener that persists every update into a HistoricalDataService.
 // For compatibility with prior code that used PersistToHistoricalListener<...>.
@@ -48,6 +52,10 @@ class PersistToHistoricalListener final : public ServiceListener<T> {
   HistoricalDataService<T>& svc_;
 };
 
+// On-disk format of a file-backed historical service: the CSV writers, or a binary
+// journal (HistoricalJournal.hpp; read it back with hist_dump).
+enum class HistoricalFormat { kCsv, kJournal };
+
 // -----------------------------------------------------------------------------
 // Historical data service base that persists to a Connector<T>.
 //
@@ -61,9 +69,17 @@ class BondHistoricalDataServiceBase : public HistoricalDataService<T> {
   // Construct with an externally owned connector
   explicit BondHistoricalDataServiceBase(Connector<T>* c) : connector_(c) {}
 
-  // Construct with an internally owned file connector
-  explicit BondHistoricalDataServiceBase(const std::string& filename)
-      : owned_connector_(MakeFileConnector(filename)), connector_(owned_connector_.get()) {}
+  // Construct with an internally owned file connector; with async, the file is
+  // written by that AsyncHistoricalWriter's thread (which must outlive this service).
+  explicit BondHistoricalDataServiceBase(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : BondHistoricalDataServiceBase(filename, HistoricalFormat::kCsv, async) {}
+
+  // A journal is written in place through its mapping, so it takes no async writer.
+  BondHistoricalDataServiceBase(const std::string& filename, HistoricalFormat format,
+                                AsyncHistoricalWriter* async = nullptr)
+      : owned_connector_(format == HistoricalFormat::kJournal ? std::make_unique<JournalConnector<T>>(filename)
+                                                              : MakeFileConnector(filename, async)),
+        connector_(owned_connector_.get()) {}
 
   // Service interface required by Service<K,V>
   T& GetData(std::string) override {
@@ -71,7 +87,7 @@ class BondHistoricalDataServiceBase : public HistoricalDataService<T> {
     return *last_;
   }
 
-  void OnMessage(T& data) override { last_ = std::make_unique<T>(data); }
+  void OnMessage(T& data) override { last_.emplace(data); }
 
   void AddListener(ServiceListener<T>*) override {}
   const std::vector<ServiceListener<T>*>& GetListeners() const override {
@@ -83,29 +99,28 @@ class BondHistoricalDataServiceBase : public HistoricalDataService<T> {
   void PersistData(std::string /*persistKey*/, const T& data) override {
     if (!connector_) return;
 
-    // Connector base expects non-const ref, so copy.
-    T tmp = data;
-    connector_->Publish(tmp);
-    last_ = std::make_unique<T>(tmp);
+    // Connector base expects non-const ref, so publish the stored copy.
+    last_.emplace(data);
+    connector_->Publish(*last_);
   }
 
  private:
   // Factory for file connectors based on T. Extend here if you add new persisted types.
-  static std::unique_ptr<Connector<T>> MakeFileConnector(const std::string& filename) {
+  static std::unique_ptr<Connector<T>> MakeFileConnector(const std::string& filename, AsyncHistoricalWriter* async) {
     if constexpr (std::is_same_v<T, Position<Bond>>) {
-      return std::make_unique<PositionFileConnector<Bond>>(filename);
+      return std::make_unique<PositionFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, Position<BucketedSector<Bond>>>) {
-      return std::make_unique<BucketPositionFileConnector<Bond>>(filename);
+      return std::make_unique<BucketPositionFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, PV01<Bond>>) {
-      return std::make_unique<RiskFileConnector<Bond>>(filename);
+      return std::make_unique<RiskFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, PV01<BucketedSector<Bond>>>) {
-      return std::make_unique<BucketRiskFileConnector<Bond>>(filename);
+      return std::make_unique<BucketRiskFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, ExecutionOrder<Bond>>) {
-      return std::make_unique<ExecutionFileConnector<Bond>>(filename);
+      return std::make_unique<ExecutionFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, PriceStream<Bond>>) {
-      return std::make_unique<StreamingFileConnector<Bond>>(filename);
+      return std::make_unique<StreamingFileConnector<Bond>>(filename, async);
     } else if constexpr (std::is_same_v<T, Inquiry<Bond>>) {
-      return std::make_unique<InquiryFileConnector<Bond>>(filename);
+      return std::make_unique<InquiryFileConnector<Bond>>(filename, async);
     } else {
       static_assert(!sizeof(T), "No file connector defined for this historical type T.");
     }
@@ -114,7 +129,7 @@ class BondHistoricalDataServiceBase : public HistoricalDataService<T> {
  private:
   std::unique_ptr<Connector<T>> owned_connector_;
   Connector<T>* connector_ = nullptr;
-  std::unique_ptr<T> last_;
+  std::optional<T> last_;
 };
 
 // Concrete type aliases you will instantiate:
@@ -35,7 +35,7 @@ class BondInquiryService final : public InquiryService<Bond> {
     if (stored.GetState() == RECEIVED && connector_) {
       // Publish a quote request with price = 100.0 (spec says quote of 100)
       Inquiry<Bond> req(stored.GetInquiryId(), stored.GetProduct(), stored.GetSide(),
-                        stored.GetQuantity(), 100.0, RECEIVED);
+                        stored.GetQuantity(), PriceTicks::FromPoints(100), RECEIVED);
       connector_->Publish(req);
     }
   }
@@ -44,7 +44,7 @@ class BondInquiryService final : public InquiryService<Bond> {
 
   const std::vector<ServiceListener<Inquiry<Bond>>*>& GetListeners() const override { return listeners_; }
 
-  void SendQuote(const std::string& inquiryId, double price) override {
+  void SendQuote(const std::string& inquiryId, PriceTicks price) override {
     // Not used directly in this year’s spec flow (connector handles QUOTED and DONE)
     (void)inquiryId;
     (void)price;
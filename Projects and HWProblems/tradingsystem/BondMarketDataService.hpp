@@ -1,62 +1,133 @@
 #ifndef BOND_MARKET_DATA_SERVICE_HPP
 #define BOND_MARKET_DATA_SERVICE_HPP
 
-#include <map>
+#include <cstdint>
+#include <iostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "marketdataservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
 
 /**
  * BondMarketDataService
- * Stores full order books keyed by product id and maintains best bid/offer.
+ * Stores full order books by dense product index and maintains best bid/offer.
+ * Snapshots (OnMessage) replace a book; deltas (OnDelta) are applied to it in place.
+ * A delta the book rejects (an update for a level it does not have) means the book
+ * has drifted from the sender's, so that product's deltas are dropped until its
+ * next snapshot.
+ * An aggregated copy of each book (one level per price) is kept alongside.
  */
-class BondMarketDataService final : public MarketDataService<Bond> {
+// Listeners: DynamicListeners<OrderBook<Bond>> or StaticListeners<OrderBook<Bond>, ...> (soa.hpp).
+template <typename Listeners = DynamicListeners<OrderBook<Bond>>>
+class BasicBondMarketDataService final : public MarketDataService<Bond> {
 public:
-  BondMarketDataService() = default;
+  explicit BasicBondMarketDataService(Listeners listeners = Listeners()) : listeners_(std::move(listeners)) {}
 
   // Service<string, OrderBook<Bond>>
-  OrderBook<Bond>& GetData(std::string key) override { return books_.at(key); }
+  OrderBook<Bond>& GetData(std::string key) override { return books_.At(key); }
 
   void OnMessage(OrderBook<Bond>& data) override {
-    const std::string pid = data.GetProduct().GetProductId();
-    books_.insert_or_assign(pid, data);
+    RecordLatency(LatencyStage::kMarketData);
+    const std::size_t idx = ProductIndexOf(data.GetProduct());
+    OrderBook<Bond>& book = books_.Emplace(idx, data);
+    if (idx >= synced_.size()) synced_.resize(idx + 1, false);
+    synced_[idx] = true;
+    aggregated_.Emplace(idx, book);
+    UpdateBest(idx, book);
 
-    // Update best bid/offer cache
-    const auto& bids = books_.at(pid).GetBidStack();
-    const auto& offers = books_.at(pid).GetOfferStack();
-    if (!bids.empty() && !offers.empty()) {
-      best_.insert_or_assign(pid, BidOffer(bids.front(), offers.front()));
-    }
-
-    for (auto* l : listeners_) {
-      if (l) l->ProcessUpdate(books_.at(pid));
-    }
+    listeners_.ForEach([&](auto& l) { l.ProcessUpdate(book); });
   }
 
   void AddListener(ServiceListener<OrderBook<Bond>>* listener) override {
-    listeners_.push_back(listener);
+    listeners_.Add(listener);
+    // Resolved once here so the delta path does not cast per update.
+    change_listeners_.push_back(dynamic_cast<OrderBookListener<Bond>*>(listener));
   }
 
   const std::vector<ServiceListener<OrderBook<Bond>>*>& GetListeners() const override {
-    return listeners_;
+    return listeners_.Get();
   }
 
   // MarketDataService<Bond>
   const BidOffer& GetBestBidOffer(const std::string& productId) override {
-    return best_.at(productId);
+    return best_.At(productId);
   }
 
+  // One level per price, with sizes at equal prices summed.
   const OrderBook<Bond>& AggregateDepth(const std::string& productId) override {
-    return books_.at(productId);
+    return aggregated_.At(productId).GetBook();
+  }
+
+  // Deltas dropped: before the product's first snapshot, or after one was rejected.
+  std::uint64_t DroppedDeltas() const { return dropped_deltas_; }
+
+  // Aggregated book with cumulative quantity and order count per level.
+  const AggregatedOrderBook<Bond>& GetAggregatedBook(const std::string& productId) {
+    return aggregated_.At(productId);
+  }
+
+  // A delta for a product with no book yet (no snapshot seen), or out of sync, is
+  // dropped and counted. Listeners hear about every other delta, even one that
+  // changes nothing, just as they hear about every snapshot.
+  void OnDelta(OrderBookDelta<Bond>& delta) override {
+    RecordLatency(LatencyStage::kMarketData);
+    const std::size_t idx = ProductIndexOf(delta.GetProduct());
+    OrderBook<Bond>* book = books_.Find(idx);
+    if (!book || !synced_[idx]) {
+      ++dropped_deltas_;
+      return;
+    }
+
+    bool rejected = false;
+    const BookChange change = delta.ApplyTo(*book, rejected);
+    if (rejected) {
+      std::cerr << "[MarketData] delta rejected on " << delta.GetProduct().GetProductId()
+                << ": waiting for a snapshot\n";
+      synced_[idx] = false;
+      ++dropped_deltas_;
+      return;
+    }
+    if (change.Any()) aggregated_.At(idx).Update(*book, change);
+    if (change.TopChanged()) UpdateBest(idx, *book);
+
+    listeners_.ForEachStatic([&](auto& l) { NotifyChange(l, *book, change); });
+    const auto& dynamic = listeners_.Get();
+    for (std::size_t i = 0; i < dynamic.size(); ++i) {
+      if (change_listeners_[i]) change_listeners_[i]->ProcessChange(*book, change);
+      else if (dynamic[i]) dynamic[i]->ProcessUpdate(*book);
+    }
   }
 
 private:
-  std::map<std::string, OrderBook<Bond>> books_;
-  std::map<std::string, BidOffer> best_;
-  std::vector<ServiceListener<OrderBook<Bond>>*> listeners_;
+  template <typename L>
+  static void NotifyChange(L& l, OrderBook<Bond>& book, const BookChange& change) {
+    if constexpr (std::is_base_of_v<OrderBookListener<Bond>, L>) l.ProcessChange(book, change);
+    else l.ProcessUpdate(book);
+  }
+
+  void UpdateBest(std::size_t idx, const OrderBook<Bond>& book) {
+    const auto& bids = book.GetBidStack();
+    const auto& offers = book.GetOfferStack();
+    if (!bids.empty() && !offers.empty()) {
+      best_.Emplace(idx, bids.front(), offers.front());
+    }
+  }
+
+  ProductTable<OrderBook<Bond>> books_;
+  ProductTable<AggregatedOrderBook<Bond>> aggregated_;
+  ProductTable<BidOffer> best_;
+  Listeners listeners_;
+  std::vector<OrderBookListener<Bond>*> change_listeners_;  // parallel to listeners_.Get(); null if plain
+  std::vector<bool> synced_;  // by product index: deltas can be applied
+  std::uint64_t dropped_deltas_ = 0;
 };
 
+using BondMarketDataService = BasicBondMarketDataService<>;
+
 #endif
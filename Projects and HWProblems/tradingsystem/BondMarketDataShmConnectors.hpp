@@ -1,53 +1,353 @@
 #ifndef BOND_MARKETDATA_SHM_CONNECTORS_HPP
 #define BOND_MARKETDATA_SHM_CONNECTORS_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "BondMarketDataWire.hpp"
 #include "BondSocketParsers.hpp"
-#include "ShmStringRingBuffer.hpp"
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
+#include "ShmBroadcastRing.hpp"
+#include "ShmByteRingBuffer.hpp"
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
 #include "soa.hpp"
 
-// Recommended queue sizing for high-throughput
-constexpr std::size_t kMdShmCapacity = 8192;
-constexpr std::size_t kMdMsgSize = 2048;
+// BOND_MD_SHM is a variable-length SPSC byte ring (one md_shm_publisher feeds one
+// trading_system). Its size is fixed by the publisher at creation and stored in the
+// segment header, so subscribers just open it. A 5-level binary book takes 184 bytes.
+constexpr std::size_t kMdShmBytes = std::size_t{1} << 20;
 
-// --------- Publisher: turns OrderBook into string and pushes to SHM ----------
+static_assert(kMdWireMaxRecordSize + sizeof(std::uint32_t) <= kMdShmBytes / 2,
+              "largest binary record must fit in the SHM ring");
+
+using MdShmQueue = ShmByteRingHandle;
+
+// Broadcast variant for fan-out to several processes (risk, GUI, recorder, ...).
+// Slots are sized for the largest binary record.
+constexpr std::size_t kMdBroadcastSlots = 4096;
+constexpr std::size_t kMdBroadcastSlotBytes = kMdWireMaxRecordSize;
+
+// After a product's first snapshot the binary publishers send deltas, with a fresh
+// snapshot every this many updates so a subscriber that joined late or missed
+// records recovers. 0 sends every book as a snapshot.
+constexpr std::size_t kMdDefaultSnapshotEvery = 100;
+
+// Push one book in the requested wire format (QueueT: MdShmQueue or ShmBroadcastWriter).
+// text_scratch is only used for kText; publishers keep one so text lines do not allocate.
+// Returns the number of bytes pushed.
+template <typename QueueT>
+inline std::size_t PushOrderBook(QueueT& shm, const OrderBook<Bond>& ob, MdWireFormat format, TextBuffer& text_scratch,
+                                 std::uint32_t seq = 0) {
+  if (format == MdWireFormat::kText) {
+    text_scratch.Clear();
+    SerializeOrderBookTo(ob, text_scratch);
+    shm.Push(text_scratch.Data(), text_scratch.Size());
+    return text_scratch.Size();
+  }
+  MdBookWire rec;
+  const std::size_t len = EncodeOrderBookWire(ob, rec, seq);
+  shm.Push(reinterpret_cast<const char*>(&rec), len);
+  return len;
+}
+
+// Turns a stream of full books into per-product snapshots and deltas (the diff
+// against the last book sent) and pushes them. A book identical to the last one
+// sent still goes out, as an empty delta, so the subscriber sees every book the
+// snapshot path would. Text format always sends snapshots.
+class MdShmBookEncoder {
+ public:
+  explicit MdShmBookEncoder(MdWireFormat format = kMdDefaultWireFormat,
+                            std::size_t snapshot_every = kMdDefaultSnapshotEvery)
+      : format_(format), snapshot_every_(format == MdWireFormat::kText ? 0 : snapshot_every) {}
+
+  template <typename QueueT>
+  void Push(QueueT& shm, const OrderBook<Bond>& ob) {
+    const std::size_t idx = ProductIndexOf(ob.GetProduct());
+    if (idx >= seq_.size()) {
+      seq_.resize(idx + 1, 0);
+      since_snapshot_.resize(idx + 1, 0);
+    }
+
+    const OrderBook<Bond>* last = last_sent_.Find(idx);
+    if (snapshot_every_ == 0 || !last || since_snapshot_[idx] >= snapshot_every_) {
+      bytes_ += PushOrderBook(shm, ob, format_, text_, ++seq_[idx]);
+      ++snapshots_;
+      since_snapshot_[idx] = 0;
+      if (snapshot_every_) last_sent_.Emplace(idx, ob);
+      return;
+    }
+
+    DiffOrderBooks(*last, ob, delta_);
+    if (delta_.Size() == 0) ++unchanged_;
+    MdDeltaWire rec;
+    const std::size_t len = EncodeOrderBookDeltaWire(delta_, rec, ++seq_[idx]);
+    shm.Push(reinterpret_cast<const char*>(&rec), len);
+    bytes_ += len;
+    ++deltas_;
+    ++since_snapshot_[idx];
+    last_sent_.Emplace(idx, ob);
+  }
+
+  std::uint64_t Snapshots() const { return snapshots_; }
+  std::uint64_t Deltas() const { return deltas_; }
+  std::uint64_t Unchanged() const { return unchanged_; }  // deltas sent empty
+  std::uint64_t Bytes() const { return bytes_; }
+
+ private:
+  MdWireFormat format_;
+  std::size_t snapshot_every_;
+  ProductTable<OrderBook<Bond>> last_sent_;
+  std::vector<std::uint32_t> seq_;             // last seq sent, by product index
+  std::vector<std::size_t> since_snapshot_;    // deltas since the last snapshot
+  OrderBookDelta<Bond> delta_;
+  TextBuffer text_;
+  std::uint64_t snapshots_ = 0;
+  std::uint64_t deltas_ = 0;
+  std::uint64_t unchanged_ = 0;
+  std::uint64_t bytes_ = 0;
+};
+
+// --------- Publisher: encodes OrderBook (binary or text) and pushes to SHM ----------
 class BondMarketDataShmPublisher : public Connector<OrderBook<Bond>> {
  public:
-  explicit BondMarketDataShmPublisher(const std::string& shm_name)
-      : shm_(shm_name, /*create=*/true) {}
+  explicit BondMarketDataShmPublisher(const std::string& shm_name,
+                                      MdWireFormat format = kMdDefaultWireFormat,
+                                      std::size_t ring_bytes = kMdShmBytes,
+                                      std::size_t snapshot_every = kMdDefaultSnapshotEvery)
+      : shm_(shm_name, /*create=*/true, ring_bytes), encoder_(format, snapshot_every) {}
 
   void Publish(OrderBook<Bond>& ob) override {
-    shm_.Push(SerializeOrderBook(ob));
+    encoder_.Push(shm_, ob);
   }
 
  private:
-  ShmQueueHandle<kMdShmCapacity, kMdMsgSize> shm_;
+  MdShmQueue shm_;
+  MdShmBookEncoder encoder_;
 };
 
-// --------- Subscriber: pops string from SHM, parses, calls Service.OnMessage ----------
+// Decodes one SHM message (either format; binary records are recognised by their
+// magic) and hands the book or delta to the service. Text lines that fail to parse
+// and binary records that fail to decode (e.g. a book deeper than OrderBook<Bond>
+// holds) are counted, logged and skipped. Latency is measured from the moment the
+// message is taken off the ring.
+//
+// Deltas are only applied on top of an unbroken per-product sequence. After a gap
+// (e.g. a lapped broadcast subscriber) the product's deltas are dropped until its
+// next snapshot.
+class MdShmBookDecoder {
+ public:
+  template <typename MarketDataServiceT>
+  void Dispatch(const char* data, std::size_t len, MarketDataServiceT& service) {
+    LatencyScope latency(LatencyIngressNs());
+    TimestampBatch batch;
+    if (IsMdDeltaWire(data, len)) {
+      std::uint32_t seq = 0;
+      try {
+        DecodeOrderBookDeltaWire(data, len, delta_, seq);
+      } catch (const std::exception& e) {
+        BadRecord(e);  // the product's next delta then shows a gap
+        return;
+      }
+      if (!InSequence(ProductIndexOf(delta_.GetProduct()), seq)) {
+        ++dropped_deltas_;
+        return;
+      }
+      RecordLatency(LatencyStage::kMdParse);
+      service.OnDelta(delta_);
+      return;
+    }
+
+    if (IsMdBookWire(data, len)) {
+      std::uint32_t seq = 0;
+      const Bond* bond = nullptr;
+      try {
+        bond = &DecodeOrderBookWire(data, len, bids_, offers_, seq);
+      } catch (const std::exception& e) {
+        BadRecord(e);
+        return;
+      }
+      Resync(ProductIndexOf(*bond), seq);
+      OrderBook<Bond> ob(*bond, bids_, offers_);
+      RecordLatency(LatencyStage::kMdParse);
+      service.OnMessage(ob);
+      return;
+    }
+
+    const Bond* bond = nullptr;
+    const ParseStatus st = TryParseOrderBookLine(std::string_view(data, len), bond, bids_, offers_);
+    stats_.Record(st);
+    if (st != ParseStatus::kOk) {
+      std::cerr << "[MdShm] parse error: " << ParseStatusName(st)
+                << " | line='" << std::string_view(data, len) << "'\n";
+      return;
+    }
+    OrderBook<Bond> ob(*bond, bids_, offers_);
+    RecordLatency(LatencyStage::kMdParse);
+    service.OnMessage(ob);
+  }
+
+  // Text-format parse counters (binary records are not counted).
+  const FeedParseStats& Stats() const { return stats_; }
+
+  // Binary records that failed to decode.
+  std::uint64_t BadRecords() const { return bad_records_; }
+
+  // Deltas dropped because they arrived out of sequence or before a snapshot.
+  std::uint64_t DroppedDeltas() const { return dropped_deltas_; }
+
+  // "text ok=0 errors=0 | binary bad=0 | dropped_deltas=0"
+  void PrintStats(std::ostream& os) const {
+    os << "text ";
+    stats_.Print(os);
+    os << " | binary bad=" << bad_records_ << " | dropped_deltas=" << dropped_deltas_;
+  }
+
+ private:
+  void BadRecord(const std::exception& e) {
+    ++bad_records_;
+    std::cerr << "[MdShm] bad binary record skipped: " << e.what() << "\n";
+  }
+
+  void Resync(std::size_t idx, std::uint32_t seq) {
+    if (idx >= last_seq_.size()) {
+      last_seq_.resize(idx + 1, 0);
+      synced_.resize(idx + 1, false);
+    }
+    last_seq_[idx] = seq;
+    synced_[idx] = true;
+  }
+
+  bool InSequence(std::size_t idx, std::uint32_t seq) {
+    if (idx < synced_.size() && synced_[idx] && seq == last_seq_[idx] + 1) {
+      last_seq_[idx] = seq;
+      return true;
+    }
+    if (idx < synced_.size() && synced_[idx]) {
+      std::cerr << "[MdShm] sequence gap on " << BondProductRepository::Instance().GetByIndex(idx).GetProductId()
+                << " (expected " << last_seq_[idx] + 1 << ", got " << seq << "): waiting for a snapshot\n";
+      synced_[idx] = false;
+    }
+    return false;
+  }
+
+  // Decode scratch, reused across messages.
+  OrderBook<Bond>::Stack bids_;
+  OrderBook<Bond>::Stack offers_;
+  OrderBookDelta<Bond> delta_;
+  FeedParseStats stats_;
+  // Per product index: last seq applied, and whether deltas can be applied.
+  std::vector<std::uint32_t> last_seq_;
+  std::vector<bool> synced_;
+  std::uint64_t bad_records_ = 0;
+  std::uint64_t dropped_deltas_ = 0;
+};
+
+// --------- Subscriber: consumes SHM slots in place, decodes, calls Service.OnMessage ----------
 template <typename MarketDataServiceT>
 class BondMarketDataShmSubscriber : public Connector<OrderBook<Bond>> {
  public:
   BondMarketDataShmSubscriber(MarketDataServiceT& svc, const std::string& shm_name)
       : service_(svc), shm_(shm_name, /*create=*/false) {}
 
+  // Reads until Stop(); books still in the ring then stay there.
+  void Subscribe() {
+    SpinBackoff idle;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      // Decode straight out of the SHM slot; the slot is released when the lambda returns.
+      if (shm_.TryConsume([this](const char* data, std::size_t len) { decoder_.Dispatch(data, len, service_); }))
+        idle = SpinBackoff();
+      else
+        idle.Pause();
+    }
+    std::cerr << "[MdShmSubscriber] ";
+    decoder_.PrintStats(std::cerr);
+    std::cerr << "\n";
+  }
+
+  // Any thread.
+  void Stop() { stop_.store(true, std::memory_order_relaxed); }
+
+  void Publish(OrderBook<Bond>&) override {
+    // subscribe-only
+  }
+
+ private:
+  MarketDataServiceT& service_;
+  MdShmQueue shm_;
+  MdShmBookDecoder decoder_;
+  std::atomic<bool> stop_{false};
+};
+
+// --------- Broadcast publisher: one writer, any number of subscriber processes ----------
+class BondMarketDataShmBroadcastPublisher : public Connector<OrderBook<Bond>> {
+ public:
+  explicit BondMarketDataShmBroadcastPublisher(const std::string& shm_name,
+                                               MdWireFormat format = kMdDefaultWireFormat,
+                                               std::size_t slots = kMdBroadcastSlots,
+                                               std::size_t snapshot_every = kMdDefaultSnapshotEvery)
+      : shm_(shm_name, slots, kMdBroadcastSlotBytes), encoder_(format, snapshot_every) {}
+
+  void Publish(OrderBook<Bond>& ob) override {
+    encoder_.Push(shm_, ob);
+  }
+
+ private:
+  ShmBroadcastWriter shm_;
+  MdShmBookEncoder encoder_;
+};
+
+// --------- Broadcast subscriber: mirrors BondMarketDataShmSubscriber with its own cursor ----------
+// A slow subscriber never holds up the publisher; if it is lapped it logs how many books
+// it missed and carries on from the recent end of the ring.
+template <typename MarketDataServiceT>
+class BondMarketDataShmBroadcastSubscriber : public Connector<OrderBook<Bond>> {
+ public:
+  BondMarketDataShmBroadcastSubscriber(MarketDataServiceT& svc, const std::string& shm_name,
+                                       ShmBroadcastReader::Start start = ShmBroadcastReader::Start::kLatest)
+      : service_(svc), shm_(shm_name, start) {}
+
+  // Reads until Stop().
   void Subscribe() {
-    while (true) {
-      std::string msg = shm_.Pop();
-      OrderBook<Bond> ob = ParseOrderBookLine(msg);
-      service_.OnMessage(ob);
+    std::uint64_t reported = 0;
+    SpinBackoff idle;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      if (!shm_.TryConsume([this](const char* data, std::size_t len) { decoder_.Dispatch(data, len, service_); })) {
+        idle.Pause();
+        continue;
+      }
+      idle = SpinBackoff();
+
+      if (shm_.Overruns() != reported) {
+        std::cerr << "[MdBroadcastSubscriber] overrun: skipped " << (shm_.Overruns() - reported)
+                  << " books (total " << shm_.Overruns() << ")\n";
+        reported = shm_.Overruns();
+      }
     }
+    std::cerr << "[MdBroadcastSubscriber] ";
+    decoder_.PrintStats(std::cerr);
+    std::cerr << " | overruns=" << shm_.Overruns() << "\n";
   }
 
+  // Any thread.
+  void Stop() { stop_.store(true, std::memory_order_relaxed); }
+
   void Publish(OrderBook<Bond>&) override {
     // subscribe-only
   }
 
  private:
   MarketDataServiceT& service_;
-  ShmQueueHandle<kMdShmCapacity, kMdMsgSize> shm_;
+  ShmBroadcastReader shm_;
+  MdShmBookDecoder decoder_;
+  std::atomic<bool> stop_{false};
 };
 
 #endif
@@ -0,0 +1,207 @@
+#ifndef BOND_MARKETDATA_WIRE_HPP
+#define BOND_MARKETDATA_WIRE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "BondPriceUtils.hpp"
+#include "BondProductRepository.hpp"
+#include "marketdataservice.hpp"
+
+// How OrderBook<Bond> travels over the SHM ring.
+//   kBinary: fixed-layout MdBookWire snapshots and MdDeltaWire incremental updates,
+//            memcpy'd in and out (default)
+//   kText  : "productId|bidPx:qty;...|offerPx:qty;..." snapshot lines, handy for debugging
+enum class MdWireFormat { kBinary, kText };
+
+constexpr MdWireFormat kMdDefaultWireFormat = MdWireFormat::kBinary;
+
+// Levels per side a binary record can carry.
+constexpr std::size_t kMdWireMaxDepth = 50;
+
+// Level updates a binary delta record can carry.
+constexpr std::size_t kMdWireMaxUpdates = 2 * kMdWireMaxDepth;
+
+// First byte is 0xFF, which never starts a text line, so a subscriber can tell
+// the formats apart message by message.
+constexpr std::uint32_t kMdBookWireMagic = 0xB00C01FFu;
+constexpr std::uint32_t kMdDeltaWireMagic = 0xB00C02FFu;
+
+struct MdLevelWire {
+  std::int64_t price_ticks;  // price in 1/256ths
+  std::int64_t quantity;
+};
+
+// Binary order book record. Levels hold bid_count bids (best first) followed by
+// offer_count offers (best first); only the used prefix is sent (MdBookWireSize).
+// seq numbers every record (snapshot or delta) per product, so a subscriber can
+// tell when it missed one.
+struct MdBookWire {
+  std::uint32_t magic;
+  std::uint32_t product_index;  // BondProductRepository dense index
+  std::uint16_t bid_count;
+  std::uint16_t offer_count;
+  std::uint32_t seq;
+  MdLevelWire levels[2 * kMdWireMaxDepth];
+};
+
+struct MdUpdateWire {
+  std::int64_t price_ticks;
+  std::int64_t quantity;
+  std::uint8_t action;  // BookAction
+  std::uint8_t side;    // PricingSide
+  std::uint16_t level;
+  std::uint32_t reserved;
+};
+
+// Binary delta record: update_count LevelUpdates for one product, applied in order.
+struct MdDeltaWire {
+  std::uint32_t magic;
+  std::uint32_t product_index;
+  std::uint32_t seq;
+  std::uint16_t update_count;
+  std::uint16_t reserved;
+  MdUpdateWire updates[kMdWireMaxUpdates];
+};
+
+static_assert(std::is_trivially_copyable_v<MdBookWire>, "MdBookWire must be memcpy-able");
+static_assert(std::is_standard_layout_v<MdBookWire>, "MdBookWire must have a fixed layout");
+static_assert(std::is_trivially_copyable_v<MdDeltaWire>, "MdDeltaWire must be memcpy-able");
+static_assert(std::is_standard_layout_v<MdDeltaWire>, "MdDeltaWire must have a fixed layout");
+
+constexpr std::size_t kMdBookWireHeaderSize = offsetof(MdBookWire, levels);
+constexpr std::size_t kMdDeltaWireHeaderSize = offsetof(MdDeltaWire, updates);
+
+// Largest record of either kind, for fixed-size ring slots.
+constexpr std::size_t kMdWireMaxRecordSize = sizeof(MdBookWire) > sizeof(MdDeltaWire) ? sizeof(MdBookWire) : sizeof(MdDeltaWire);
+
+inline std::size_t MdBookWireSize(std::size_t level_count) {
+  return kMdBookWireHeaderSize + level_count * sizeof(MdLevelWire);
+}
+
+inline std::size_t MdDeltaWireSize(std::size_t update_count) {
+  return kMdDeltaWireHeaderSize + update_count * sizeof(MdUpdateWire);
+}
+
+inline bool HasMdWireMagic(const char* data, std::size_t len, std::size_t header_size, std::uint32_t expected) {
+  if (len < header_size) return false;
+  std::uint32_t magic = 0;
+  std::memcpy(&magic, data, sizeof(magic));
+  return magic == expected;
+}
+
+inline bool IsMdBookWire(const char* data, std::size_t len) {
+  return HasMdWireMagic(data, len, kMdBookWireHeaderSize, kMdBookWireMagic);
+}
+
+inline bool IsMdDeltaWire(const char* data, std::size_t len) {
+  return HasMdWireMagic(data, len, kMdDeltaWireHeaderSize, kMdDeltaWireMagic);
+}
+
+// Length of the MdBookWire record at data, from its header, for walking records
+// stored back to back. Throws if it is not one or runs past len.
+inline std::size_t MdBookWireRecordSize(const char* data, std::size_t len) {
+  if (!IsMdBookWire(data, len)) throw std::runtime_error("Bad orderbook wire record");
+  MdBookWire hdr;
+  std::memcpy(&hdr, data, kMdBookWireHeaderSize);
+  const std::size_t size = MdBookWireSize(static_cast<std::size_t>(hdr.bid_count) + hdr.offer_count);
+  if (size > len) throw std::runtime_error("Truncated orderbook wire record");
+  return size;
+}
+
+static_assert(OrderBook<Bond>::Stack::kDepth <= kMdWireMaxDepth, "OrderBook<Bond> deeper than the wire record");
+static_assert(OrderBookDelta<Bond>::kMaxUpdates <= kMdWireMaxUpdates, "OrderBookDelta<Bond> larger than the wire record");
+
+// Fill out from ob; returns the number of bytes to send.
+inline std::size_t EncodeOrderBookWire(const OrderBook<Bond>& ob, MdBookWire& out, std::uint32_t seq = 0) {
+  const auto& bids = ob.GetBidStack();
+  const auto& offers = ob.GetOfferStack();
+
+  out.magic = kMdBookWireMagic;
+  out.product_index =
+      static_cast<std::uint32_t>(BondProductRepository::Instance().IndexOf(ob.GetProduct()));
+  out.bid_count = static_cast<std::uint16_t>(bids.size());
+  out.offer_count = static_cast<std::uint16_t>(offers.size());
+  out.seq = seq;
+
+  std::size_t n = 0;
+  for (const auto& o : bids) out.levels[n++] = MdLevelWire{o.GetPrice().Ticks(), o.GetQuantity()};
+  for (const auto& o : offers) out.levels[n++] = MdLevelWire{o.GetPrice().Ticks(), o.GetQuantity()};
+  return MdBookWireSize(n);
+}
+
+// Decode a binary record into caller-owned stacks (cleared first). Returns the
+// product; seq receives the record's sequence number. Throws on a malformed record
+// or one deeper than OrderBook<Bond> holds.
+inline const Bond& DecodeOrderBookWire(const char* data, std::size_t len,
+                                       OrderBook<Bond>::Stack& bids, OrderBook<Bond>::Stack& offers,
+                                       std::uint32_t& seq) {
+  if (!IsMdBookWire(data, len)) throw std::runtime_error("Bad orderbook wire record");
+
+  MdBookWire hdr;
+  std::memcpy(&hdr, data, kMdBookWireHeaderSize);
+
+  const std::size_t n = static_cast<std::size_t>(hdr.bid_count) + hdr.offer_count;
+  if (hdr.bid_count > kMdWireMaxDepth || hdr.offer_count > kMdWireMaxDepth || len < MdBookWireSize(n))
+    throw std::runtime_error("Truncated orderbook wire record");
+  if (hdr.bid_count > bids.capacity() || hdr.offer_count > offers.capacity())
+    throw std::runtime_error("Orderbook wire record deeper than OrderBook<Bond>");
+
+  const Bond& bond = BondProductRepository::Instance().GetByIndex(hdr.product_index);
+  seq = hdr.seq;
+
+  bids.clear();
+  offers.clear();
+  const char* p = data + kMdBookWireHeaderSize;
+  for (std::size_t i = 0; i < n; ++i, p += sizeof(MdLevelWire)) {
+    MdLevelWire lvl;
+    std::memcpy(&lvl, p, sizeof(lvl));
+    if (i < hdr.bid_count) bids.push_back(Order(PriceTicks(lvl.price_ticks), lvl.quantity, BID));
+    else offers.push_back(Order(PriceTicks(lvl.price_ticks), lvl.quantity, OFFER));
+  }
+  return bond;
+}
+
+inline std::size_t EncodeOrderBookDeltaWire(const OrderBookDelta<Bond>& delta, MdDeltaWire& out, std::uint32_t seq) {
+  out.magic = kMdDeltaWireMagic;
+  out.product_index = static_cast<std::uint32_t>(BondProductRepository::Instance().IndexOf(delta.GetProduct()));
+  out.seq = seq;
+  out.update_count = static_cast<std::uint16_t>(delta.Size());
+  out.reserved = 0;
+
+  std::size_t n = 0;
+  for (const LevelUpdate& u : delta) {
+    out.updates[n++] = MdUpdateWire{u.GetPrice().Ticks(), u.GetQuantity(), static_cast<std::uint8_t>(u.GetAction()),
+                                    static_cast<std::uint8_t>(u.GetSide()), static_cast<std::uint16_t>(u.GetLevel()), 0};
+  }
+  return MdDeltaWireSize(n);
+}
+
+// Decode a binary delta into a caller-owned delta (reset first). Throws on a
+// malformed record.
+inline void DecodeOrderBookDeltaWire(const char* data, std::size_t len, OrderBookDelta<Bond>& delta, std::uint32_t& seq) {
+  if (!IsMdDeltaWire(data, len)) throw std::runtime_error("Bad orderbook delta wire record");
+
+  MdDeltaWire hdr;
+  std::memcpy(&hdr, data, kMdDeltaWireHeaderSize);
+  if (hdr.update_count > OrderBookDelta<Bond>::kMaxUpdates || len < MdDeltaWireSize(hdr.update_count))
+    throw std::runtime_error("Truncated orderbook delta wire record");
+
+  delta.Reset(BondProductRepository::Instance().GetByIndex(hdr.product_index));
+  seq = hdr.seq;
+
+  const char* p = data + kMdDeltaWireHeaderSize;
+  for (std::size_t i = 0; i < hdr.update_count; ++i, p += sizeof(MdUpdateWire)) {
+    MdUpdateWire u;
+    std::memcpy(&u, p, sizeof(u));
+    if (u.action > BOOK_DELETE || u.side > OFFER) throw std::runtime_error("Bad orderbook delta update");
+    delta.Add(LevelUpdate(static_cast<BookAction>(u.action), static_cast<PricingSide>(u.side), u.level,
+                          PriceTicks(u.price_ticks), u.quantity));
+  }
+}
+
+#endif
@@ -1,10 +1,12 @@
 #ifndef BOND_POSITION_SERVICE_HPP
 #define BOND_POSITION_SERVICE_HPP
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "positionservice.hpp"
 #include "products.hpp"    // Bond + BucketNameForProduct
 #include "riskservice.hpp" // BucketedSector
@@ -14,49 +16,42 @@
 /**
  * BondPositionService
  *
- * Maintains per-security Position<Bond> keyed by product id.
+ * Maintains per-security Position<Bond> by dense product index.
  * Also provides a helper to aggregate positions into a bucketed sector
  * (FrontEnd / Belly / LongEnd) via BucketNameForProduct(product_id).
  */
-class BondPositionService final : public PositionService<Bond>,
-                                 public ServiceListener<Trade<Bond>> {
+// Listeners: DynamicListeners<Position<Bond>> or StaticListeners<Position<Bond>, ...> (soa.hpp).
+template <typename Listeners = DynamicListeners<Position<Bond>>>
+class BasicBondPositionService final : public PositionService<Bond>,
+                                      public ServiceListener<Trade<Bond>> {
 public:
-  BondPositionService() = default;
+  explicit BasicBondPositionService(Listeners listeners = Listeners()) : listeners_(std::move(listeners)) {}
 
   // Service<string, Position<Bond>>
-  Position<Bond>& GetData(std::string key) override { return positions_.at(key); }
+  Position<Bond>& GetData(std::string key) override { return positions_.At(key); }
 
   void OnMessage(Position<Bond>& data) override {
-    const std::string pid = data.GetProduct().GetProductId();
-    positions_.insert_or_assign(pid, data);
-    for (auto* l : listeners_) {
-      if (l) l->ProcessUpdate(positions_.at(pid));
-    }
+    Position<Bond>& stored = positions_.Emplace(ProductIndexOf(data.GetProduct()), data);
+    listeners_.ForEach([&](auto& l) { l.ProcessUpdate(stored); });
   }
 
   void AddListener(ServiceListener<Position<Bond>>* listener) override {
-    listeners_.push_back(listener);
+    listeners_.Add(listener);
   }
 
   const std::vector<ServiceListener<Position<Bond>>*>& GetListeners() const override {
-    return listeners_;
+    return listeners_.Get();
   }
 
   // PositionService<Bond>
   void AddTrade(const Trade<Bond>& trade) override {
-    const std::string pid = trade.GetProduct().GetProductId();
-
-    auto it = positions_.find(pid);
-    if (it == positions_.end()) {
-      it = positions_.emplace(pid, Position<Bond>(trade.GetProduct())).first;
-    }
+    RecordLatency(LatencyStage::kPosition);
+    Position<Bond>& pos = positions_.FindOrEmplace(ProductIndexOf(trade.GetProduct()), trade.GetProduct());
 
     const long signed_qty = (trade.GetSide() == BUY) ? trade.GetQuantity() : -trade.GetQuantity();
-    it->second.AddPosition(trade.GetBook(), signed_qty);
+    pos.AddPosition(trade.GetBook(), signed_qty);
 
-    for (auto* l : listeners_) {
-      if (l) l->ProcessUpdate(it->second);
-    }
+    listeners_.ForEach([&](auto& l) { l.ProcessUpdate(pos); });
   }
 
   /**
@@ -65,10 +60,10 @@ public:
    */
   Position<BucketedSector<Bond>> GetBucketedPosition(const BucketedSector<Bond>& sector) const {
     long qty_sum = 0;
-    for (const auto& kv : positions_) {
-      if (BucketNameForProduct(kv.first) != sector.GetName()) continue;
-      qty_sum += kv.second.GetAggregatePosition();
-    }
+    positions_.ForEach([&](std::size_t, const Position<Bond>& p) {
+      if (BucketNameForProduct(p.GetProduct().GetProductId()) != sector.GetName()) return;
+      qty_sum += p.GetAggregatePosition();
+    });
 
     Position<BucketedSector<Bond>> bucket_pos(sector);
     bucket_pos.SetPosition("AGG", qty_sum);
@@ -81,8 +76,10 @@ public:
   void ProcessUpdate(Trade<Bond>& trade) override { AddTrade(trade); }
 
 private:
-  std::map<std::string, Position<Bond>> positions_;
-  std::vector<ServiceListener<Position<Bond>>*> listeners_;
+  ProductTable<Position<Bond>> positions_;
+  Listeners listeners_;
 };
 
+using BondPositionService = BasicBondPositionService<>;
+
 #endif
@@ -1,56 +1,117 @@
 #ifndef BOND_PRICE_UTILS_HPP
 #define BOND_PRICE_UTILS_HPP
 
-#include <cctype>
+#include <charconv>
 #include <cmath>
-#include <sstream>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 
-inline double ParsePriceMaybeFractional(const std::string& s) {
-  // Accept decimal or "100-25+" style.
-  // If no '-', parse as double.
-  if (s.find('-') == std::string::npos) return std::stod(s);
+#include "PriceTicks.hpp"
+#include "TextBuffer.hpp"
 
-  // Format: WHOLE-XYz where XY in [00..31], z in [0..7] or '+'
-  // '+' means z=4.
-  auto dash = s.find('-');
-  if (dash == std::string::npos || dash + 1 >= s.size()) throw std::runtime_error("Bad price: " + s);
+// Non-throwing price parser. Accepts decimal ("99.5", snapped to the nearest 1/256)
+// or fractional "WHOLE-XYz": XY in [00..31] 32nds, z in [0..7] 256ths or '+' for 4.
+// A leading '-' is a sign, so "-1-160" is -1 + 16/32.
+inline bool TryParsePriceTicks(std::string_view s, PriceTicks& out) {
+  if (s.empty()) return false;
+  const char* p = s.data();
+  const char* end = p + s.size();
+  const bool neg = (p != end && *p == '-');
+  const char* digits = neg ? p + 1 : p;
 
-  int whole = std::stoi(s.substr(0, dash));
-  std::string frac = s.substr(dash + 1);
-  if (frac.size() != 3) throw std::runtime_error("Bad fractional price: " + s);
+  const char* dash = static_cast<const char*>(std::memchr(digits, '-', static_cast<std::size_t>(end - digits)));
+  if (!dash) {
+    double px = 0.0;
+    auto [q, ec] = std::from_chars(p, end, px);
+    if (ec != std::errc() || q != end || !std::isfinite(px)) return false;
+    out = PriceTicks::FromDouble(px);
+    return true;
+  }
 
-  int xy = std::stoi(frac.substr(0, 2));
-  char zc = frac[2];
-  int z = 0;
-  if (zc == '+') z = 4;
-  else if (std::isdigit(static_cast<unsigned char>(zc))) z = zc - '0';
-  else throw std::runtime_error("Bad fractional z: " + s);
+  // Whole points: at most 15 digits keeps ticks well inside int64.
+  if (dash == digits || dash - digits > 15 || end - dash != 4) return false;
+  std::int64_t whole = 0;
+  for (const char* q = digits; q != dash; ++q) {
+    const unsigned d = static_cast<unsigned>(*q - '0');
+    if (d > 9) return false;
+    whole = whole * 10 + d;
+  }
 
-  if (xy < 0 || xy > 31 || z < 0 || z > 7) throw std::runtime_error("Fraction out of range: " + s);
+  const unsigned x = static_cast<unsigned>(dash[1] - '0');
+  const unsigned y = static_cast<unsigned>(dash[2] - '0');
+  if (x > 9 || y > 9) return false;
+  const unsigned xy = x * 10 + y;
 
-  // xy/32 + z/256
-  return static_cast<double>(whole) + static_cast<double>(xy) / 32.0 + static_cast<double>(z) / 256.0;
+  const char zc = dash[3];
+  const unsigned z = (zc == '+') ? 4u : static_cast<unsigned>(zc - '0');
+  if (xy > 31 || z > 7) return false;
+
+  // whole + xy/32 + z/256
+  out = PriceTicks::FromPoints(neg ? -whole : whole) + PriceTicks(xy * 8 + z);
+  return true;
+}
+
+inline PriceTicks ParsePriceTicks(std::string_view s) {
+  PriceTicks px;
+  if (!TryParsePriceTicks(s, px)) throw std::runtime_error("Bad price: " + std::string(s));
+  return px;
+}
+
+// Decimal view of ParsePriceTicks, for analytics code that wants a double.
+inline double ParsePriceMaybeFractional(std::string_view s) {
+  return ParsePriceTicks(s).ToDouble();
+}
+
+// Fractional suffix "-XYz" for every tick within a point, built once at compile time.
+struct PriceFractionTable {
+  char suffix[PriceTicks::kTicksPerPoint][4];
+
+  constexpr PriceFractionTable() : suffix() {
+    for (int t = 0; t < PriceTicks::kTicksPerPoint; ++t) {
+      const int xy = t / 8;  // /32 in 256ths => 8 ticks
+      const int z = t % 8;
+      suffix[t][0] = '-';
+      suffix[t][1] = static_cast<char>('0' + xy / 10);
+      suffix[t][2] = static_cast<char>('0' + xy % 10);
+      suffix[t][3] = (z == 4) ? '+' : static_cast<char>('0' + z);
+    }
+  }
+};
+
+inline constexpr PriceFractionTable kPriceFractions{};
+
+// Longest output of WritePriceFractional: int64 whole points plus the suffix.
+constexpr std::size_t kMaxPriceFractionalChars = 24;
+
+// Writes "WHOLE-XYz" at out (room for kMaxPriceFractionalChars) and returns the end.
+inline char* WritePriceFractional(char* out, PriceTicks px) {
+  // Floor division so negative prices still get a fraction in [0, 256).
+  const std::int64_t t = px.Ticks();
+  std::int64_t whole = t / PriceTicks::kTicksPerPoint;
+  std::int64_t ticks256 = t % PriceTicks::kTicksPerPoint;
+  if (ticks256 < 0) { ticks256 += PriceTicks::kTicksPerPoint; whole -= 1; }
+
+  out = std::to_chars(out, out + kMaxPriceFractionalChars - 4, whole).ptr;
+  std::memcpy(out, kPriceFractions.suffix[ticks256], 4);
+  return out + 4;
+}
+
+inline void AppendPriceFractional(TextBuffer& buf, PriceTicks px) {
+  buf.Commit(WritePriceFractional(buf.Reserve(kMaxPriceFractionalChars), px));
+}
+
+inline std::string FormatPriceFractional(PriceTicks px) {
+  char tmp[kMaxPriceFractionalChars];
+  return std::string(tmp, WritePriceFractional(tmp, px));
 }
 
 inline std::string FormatPriceFractional(double px) {
   // Convert to nearest 1/256.
-  double whole_d = std::floor(px);
-  int whole = static_cast<int>(whole_d);
-  double frac = px - whole_d;
-  int ticks256 = static_cast<int>(std::llround(frac * 256.0));
-  if (ticks256 == 256) { whole += 1; ticks256 = 0; }
-
-  int xy = ticks256 / 8;     // /32 in 256ths => 8 ticks
-  int z = ticks256 % 8;
-
-  std::ostringstream oss;
-  oss << whole << "-";
-  if (xy < 10) oss << "0";
-  oss << xy;
-  oss << (z == 4 ? '+' : static_cast<char>('0' + z));
-  return oss.str();
+  return FormatPriceFractional(PriceTicks::FromDouble(px));
 }
 
 #endif
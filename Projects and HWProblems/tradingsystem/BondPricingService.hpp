@@ -1,10 +1,11 @@
 #ifndef BOND_PRICING_SERVICE_HPP
 #define BOND_PRICING_SERVICE_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "pricingservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
@@ -13,14 +14,14 @@ class BondPricingService final : public PricingService<Bond> {
 public:
     BondPricingService() = default;
 
-    Price<Bond>& GetData(std::string key) override { return prices_.at(key); }
+    Price<Bond>& GetData(std::string key) override { return prices_.At(key); }
 
     void OnMessage(Price<Bond>& data) override 
     {
-        const std::string pid = data.GetProduct().GetProductId();
-        prices_.erase(pid);
-        prices_.emplace(pid, Price<Bond>(data.GetProduct(), data.GetMid(), data.GetBidOfferSpread()));
-        for (auto* l : listeners_) l->ProcessUpdate(prices_.at(pid));
+        RecordLatency(LatencyStage::kPricing);
+        Price<Bond>& stored = prices_.Emplace(ProductIndexOf(data.GetProduct()),
+                                              data.GetProduct(), data.GetMid(), data.GetBidOfferSpread());
+        for (auto* l : listeners_) l->ProcessUpdate(stored);
     }
 
     void AddListener(ServiceListener<Price<Bond>>* listener) override 
@@ -34,7 +35,7 @@ public:
     }
 
 private:
-    std::map<std::string, Price<Bond>> prices_;
+    ProductTable<Price<Bond>> prices_;
     std::vector<ServiceListener<Price<Bond>>*> listeners_;
 };
 
@@ -1,12 +1,19 @@
 #ifndef BOND_PRODUCT_REPOSITORY_HPP
 #define BOND_PRODUCT_REPOSITORY_HPP
 
-#include <map>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include "products.hpp"
 
+// Owns every Bond for the life of the process. Service values (Price, OrderBook,
+// Trade, Position, ...) only point at the Bond they refer to, so a bond must be
+// registered here before any message about it is built, and is never removed.
 class BondProductRepository {
  public:
   static BondProductRepository& Instance() {
@@ -15,24 +22,67 @@ class BondProductRepository {
   }
 
   // Register bond metadata (call once at startup in each process).
+  // Each new product gets the next dense index (0, 1, 2, ...) in registration order,
+  // so processes that run RegisterBondUniverse() agree on the numbering.
   void Register(const std::string& product_id,
                 BondIdType id_type,
                 const std::string& ticker,
                 float coupon,
                 const boost::gregorian::date& maturity) {
-    bonds_.emplace(product_id, Bond(product_id, id_type, ticker, coupon, maturity));
+    if (index_by_id_.count(product_id)) return;
+    bonds_.emplace_back(product_id, id_type, ticker, coupon, maturity);
+    bonds_.back().SetProductIndex(bonds_.size() - 1);
+    ids_.push_back(bonds_.back().GetProductId());
+    index_by_id_.emplace(ids_.back(), bonds_.size() - 1);
   }
 
   // Get stable reference. Throws if missing.
-  const Bond& Get(const std::string& product_id) const {
-    auto it = bonds_.find(product_id);
-    if (it == bonds_.end()) throw std::runtime_error("Unknown Bond product_id: " + product_id);
+  const Bond& Get(std::string_view product_id) const {
+    return bonds_[IndexOf(product_id)];
+  }
+
+  // Non-throwing lookup for the line parsers; nullptr if missing. No allocation.
+  const Bond* Find(std::string_view product_id) const {
+    // A handful of short ids compare faster than they hash.
+    if (ids_.size() <= kLinearScanMax) {
+      for (std::size_t i = 0; i < ids_.size(); ++i)
+        if (ids_[i] == product_id) return &bonds_[i];
+      return nullptr;
+    }
+    auto it = index_by_id_.find(product_id);
+    return (it == index_by_id_.end()) ? nullptr : &bonds_[it->second];
+  }
+
+  // Dense index of a registered product. Throws if missing.
+  std::size_t IndexOf(std::string_view product_id) const {
+    auto it = index_by_id_.find(product_id);
+    if (it == index_by_id_.end()) throw std::runtime_error("Unknown Bond product_id: " + std::string(product_id));
     return it->second;
   }
 
+  // Dense index of a bond: O(1) for registered bonds and their copies, falls back
+  // to the id lookup for a Bond built outside the repository.
+  std::size_t IndexOf(const Bond& bond) const {
+    const std::size_t index = bond.GetProductIndex();
+    return (index != kNoProductIndex) ? index : IndexOf(std::string_view(bond.GetProductId()));
+  }
+
+  // Get stable reference by dense index. Throws if out of range.
+  const Bond& GetByIndex(std::size_t index) const {
+    if (index >= bonds_.size()) throw std::runtime_error("Unknown Bond index: " + std::to_string(index));
+    return bonds_[index];
+  }
+
+  std::size_t Size() const { return bonds_.size(); }
+
  private:
+  static constexpr std::size_t kLinearScanMax = 16;
+
   BondProductRepository() = default;
-  std::map<std::string, Bond> bonds_;
+  std::deque<Bond> bonds_;  // deque keeps references stable as bonds are added
+  // Keys view the ids held by bonds_, so lookups by string_view need no allocation.
+  std::vector<std::string_view> ids_;  // ids_[i] is bonds_[i]'s product id
+  std::unordered_map<std::string_view, std::size_t> index_by_id_;
 };
 
 #endif
\ No newline at end of file
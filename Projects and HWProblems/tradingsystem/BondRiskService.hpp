@@ -1,10 +1,12 @@
 #ifndef BOND_RISK_SERVICE_HPP
 #define BOND_RISK_SERVICE_HPP
 
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "products.hpp"    // Bond + BucketNameForProduct
 #include "riskservice.hpp"
 #include "soa.hpp"
@@ -15,26 +17,25 @@
  * Listens to Position<Bond> updates and computes PV01<Bond> per security.
  * Also supports bucketed PV01 for (FrontEnd, Belly, LongEnd).
  */
-class BondRiskService final : public RiskService<Bond>,
-                              public ServiceListener<Position<Bond>> {
+// Listeners: DynamicListeners<PV01<Bond>> or StaticListeners<PV01<Bond>, ...> (soa.hpp).
+template <typename Listeners = DynamicListeners<PV01<Bond>>>
+class BasicBondRiskService final : public RiskService<Bond>,
+                                  public ServiceListener<Position<Bond>> {
 public:
-  BondRiskService() = default;
+  explicit BasicBondRiskService(Listeners listeners = Listeners()) : listeners_(std::move(listeners)) {}
 
   // Service<string, PV01<Bond>>
-  PV01<Bond>& GetData(std::string key) override { return risks_.at(key); }
+  PV01<Bond>& GetData(std::string key) override { return risks_.At(key); }
 
   void OnMessage(PV01<Bond>& data) override {
-    const std::string pid = data.GetProduct().GetProductId();
-    risks_.insert_or_assign(pid, data);
-    for (auto* l : listeners_) {
-      if (l) l->ProcessUpdate(risks_.at(pid));
-    }
+    PV01<Bond>& stored = risks_.Emplace(ProductIndexOf(data.GetProduct()), data);
+    listeners_.ForEach([&](auto& l) { l.ProcessUpdate(stored); });
   }
 
-  void AddListener(ServiceListener<PV01<Bond>>* listener) override { listeners_.push_back(listener); }
+  void AddListener(ServiceListener<PV01<Bond>>* listener) override { listeners_.Add(listener); }
 
   const std::vector<ServiceListener<PV01<Bond>>*>& GetListeners() const override {
-    return listeners_;
+    return listeners_.Get();
   }
 
   // ServiceListener<Position<Bond>>
@@ -44,11 +45,13 @@ public:
 
   // RiskService<Bond>
   void AddPosition(Position<Bond>& position) override {
+    RecordLatency(LatencyStage::kRisk);
     const Bond& bond = position.GetProduct();
-    const std::string pid = bond.GetProductId();
+    const std::size_t idx = ProductIndexOf(bond);
 
     const long qty = position.GetAggregatePosition();
-    const double pv01_per_unit = PV01PerUnit(pid);
+    // Per-unit PV01 is fixed per product: work it out from the id once.
+    const double pv01_per_unit = pv01_per_unit_.FindOrEmplace(idx, PV01PerUnit(bond.GetProductId()));
 
     PV01<Bond> pv01(bond, pv01_per_unit, qty);
     OnMessage(pv01);
@@ -60,12 +63,11 @@ public:
     double pv01_sum = 0.0;
     long qty_sum = 0;
 
-    for (const auto& kv : risks_) {
-      const std::string& pid = kv.first;
-      if (BucketNameForProduct(pid) != bucket_name) continue;
-      pv01_sum += kv.second.GetPV01() * static_cast<double>(kv.second.GetQuantity());
-      qty_sum += kv.second.GetQuantity();
-    }
+    risks_.ForEach([&](std::size_t, const PV01<Bond>& r) {
+      if (BucketNameForProduct(r.GetProduct().GetProductId()) != bucket_name) return;
+      pv01_sum += r.GetPV01() * static_cast<double>(r.GetQuantity());
+      qty_sum += r.GetQuantity();
+    });
 
     cached_bucket_ = PV01<BucketedSector<Bond>>(sector, pv01_sum, qty_sum);
     return cached_bucket_;
@@ -83,10 +85,13 @@ private:
     return 0.050;
   }
 
-  std::map<std::string, PV01<Bond>> risks_;
-  std::vector<ServiceListener<PV01<Bond>>*> listeners_;
-  mutable PV01<BucketedSector<Bond>> cached_bucket_ =
-      PV01<BucketedSector<Bond>>(BucketedSector<Bond>({}, "EMPTY"), 0.0, 0);
+  ProductTable<PV01<Bond>> risks_;
+  ProductTable<double> pv01_per_unit_;
+  Listeners listeners_;
+  BucketedSector<Bond> empty_sector_ = BucketedSector<Bond>({}, "EMPTY");
+  mutable PV01<BucketedSector<Bond>> cached_bucket_ = PV01<BucketedSector<Bond>>(empty_sector_, 0.0, 0);
 };
 
+using BondRiskService = BasicBondRiskService<>;
+
 #endif
@@ -0,0 +1,281 @@
+#ifndef BOND_SEQUENCER_HPP
+#define BOND_SEQUENCER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "CsvUtils.hpp"
+#include "LatencyHistogram.hpp"
+#include "MpscQueue.hpp"
+#include "Timestamp.hpp"
+#include "inquiryservice.hpp"
+#include "marketdataservice.hpp"
+#include "pricingservice.hpp"
+#include "tradebookingservice.hpp"
+
+// Single-writer mode: the inbound connectors only parse and enqueue, and one thread
+// (BondSequencer::Run) drains the queues and drives every service. Service code then
+// runs on one thread in one well-defined order, with no locks.
+//
+// The Queued* types stand in for a service in an inbound connector: their
+// OnMessage/OnDelta copy the message, with its ingress time, into the feed's queue
+// and return.
+
+enum class SequencerFeed : std::uint8_t { kMarketData, kPrices, kTrades, kInquiries, kCount };
+
+constexpr std::size_t kSequencerFeedCount = static_cast<std::size_t>(SequencerFeed::kCount);
+
+using SequencerPriority = std::array<SequencerFeed, kSequencerFeedCount>;
+
+constexpr SequencerPriority kDefaultSequencerPriority = {SequencerFeed::kMarketData, SequencerFeed::kTrades,
+                                                         SequencerFeed::kPrices, SequencerFeed::kInquiries};
+
+constexpr std::size_t kDefaultSequencerQueueCapacity = 8192;
+
+inline const char* SequencerFeedName(SequencerFeed f) {
+  switch (f) {
+    case SequencerFeed::kMarketData: return "md";
+    case SequencerFeed::kPrices: return "px";
+    case SequencerFeed::kTrades: return "tr";
+    case SequencerFeed::kInquiries: return "iq";
+    case SequencerFeed::kCount: break;
+  }
+  return "unknown";
+}
+
+// "md,tr,px,iq": every feed exactly once, highest priority first. Throws
+// std::invalid_argument otherwise.
+inline SequencerPriority ParseSequencerPriority(std::string_view s) {
+  std::string_view names[kSequencerFeedCount];
+  if (SplitFields(s, ',', names, kSequencerFeedCount) != kSequencerFeedCount)
+    throw std::invalid_argument("Sequencer priority needs all four feeds: " + std::string(s));
+
+  SequencerPriority out{};
+  std::array<bool, kSequencerFeedCount> seen{};
+  for (std::size_t i = 0; i < kSequencerFeedCount; ++i) {
+    std::size_t f = 0;
+    while (f < kSequencerFeedCount && names[i] != SequencerFeedName(static_cast<SequencerFeed>(f))) ++f;
+    if (f == kSequencerFeedCount || seen[f])
+      throw std::invalid_argument("Bad sequencer priority: " + std::string(s));
+    seen[f] = true;
+    out[i] = static_cast<SequencerFeed>(f);
+  }
+  return out;
+}
+
+// A queued message and the ingress time it is measured from (LatencyScope).
+template <typename V>
+struct Sequenced {
+  template <typename... Args>
+  explicit Sequenced(std::int64_t ns, Args&&... args) : ingress_ns(ns), value(std::forward<Args>(args)...) {}
+
+  std::int64_t ingress_ns;
+  V value;
+};
+
+template <typename V>
+class QueuedService {
+ public:
+  explicit QueuedService(MpscQueue<Sequenced<V>>& queue) : queue_(queue) {}
+
+  void OnMessage(V& data) { queue_.Push(LatencyScope::CurrentNs(), data); }
+
+ private:
+  MpscQueue<Sequenced<V>>& queue_;
+};
+
+// Snapshots and deltas share one queue so they stay in feed order.
+using MarketDataMessage = std::variant<OrderBook<Bond>, OrderBookDelta<Bond>>;
+
+class QueuedMarketDataService {
+ public:
+  explicit QueuedMarketDataService(MpscQueue<Sequenced<MarketDataMessage>>& queue) : queue_(queue) {}
+
+  void OnMessage(OrderBook<Bond>& book) {
+    queue_.Push(LatencyScope::CurrentNs(), std::in_place_type<OrderBook<Bond>>, book);
+  }
+  void OnDelta(OrderBookDelta<Bond>& delta) {
+    queue_.Push(LatencyScope::CurrentNs(), std::in_place_type<OrderBookDelta<Bond>>, delta);
+  }
+
+ private:
+  MpscQueue<Sequenced<MarketDataMessage>>& queue_;
+};
+
+// Drains the feed queues in strict priority order: after each message it goes back
+// to the highest-priority queue with something in it. A busy high-priority feed can
+// therefore hold back the others; the depths printed every report_interval show it.
+template <typename MarketDataServiceT, typename PricingServiceT, typename TradeBookingServiceT,
+          typename InquiryServiceT>
+class BondSequencer {
+ public:
+  BondSequencer(MarketDataServiceT& marketdata, PricingServiceT& pricing, TradeBookingServiceT& tradebooking,
+                InquiryServiceT& inquiry, SequencerPriority priority = kDefaultSequencerPriority,
+                std::size_t queue_capacity = kDefaultSequencerQueueCapacity,
+                std::chrono::milliseconds report_interval = std::chrono::seconds(5))
+      : marketdata_(marketdata),
+        pricing_(pricing),
+        tradebooking_(tradebooking),
+        inquiry_(inquiry),
+        priority_(priority),
+        report_interval_(report_interval),
+        md_queue_(queue_capacity),
+        px_queue_(queue_capacity),
+        tr_queue_(queue_capacity),
+        iq_queue_(queue_capacity),
+        md_in_(md_queue_),
+        px_in_(px_queue_),
+        tr_in_(tr_queue_),
+        iq_in_(iq_queue_) {}
+
+  BondSequencer(const BondSequencer&) = delete;
+  BondSequencer& operator=(const BondSequencer&) = delete;
+
+  // Targets for the inbound connectors (any thread).
+  QueuedMarketDataService& MarketDataInbound() { return md_in_; }
+  QueuedService<Price<Bond>>& PricingInbound() { return px_in_; }
+  QueuedService<Trade<Bond>>& TradesInbound() { return tr_in_; }
+  QueuedService<Inquiry<Bond>>& InquiriesInbound() { return iq_in_; }
+
+  // Event loop; the only thread that calls into the services. After Stop() it
+  // handles everything still queued, then returns.
+  void Run() {
+    auto next_report = std::chrono::steady_clock::now() + report_interval_;
+    std::uint64_t reported = 0;
+    SpinBackoff idle;
+    for (std::uint32_t n = 0; !stop_.load(std::memory_order_acquire); ++n) {
+      if (PollOnce()) idle = SpinBackoff();
+      else idle.Pause();
+
+      if (report_interval_.count() <= 0 || (n & 255) != 0) continue;
+      const auto now = std::chrono::steady_clock::now();
+      if (now < next_report) continue;
+      next_report = now + report_interval_;
+      if (Processed() == reported) continue;
+      reported = Processed();
+      std::cerr << "[Sequencer] ";
+      PrintDepths(std::cerr);
+      std::cerr << "\n";
+    }
+    while (PollOnce()) {
+    }
+  }
+
+  // Stop the feeds first: whatever they push after Run() has drained is not handled.
+  // Release, so the final drain sees every push made before this call.
+  void Stop() { stop_.store(true, std::memory_order_release); }
+
+  // Handles the oldest message of the highest-priority non-empty queue. Returns false
+  // if every queue was empty.
+  bool PollOnce() {
+    for (SequencerFeed f : priority_) {
+      if (Poll(f)) return true;
+    }
+    return false;
+  }
+
+  std::size_t Depth(SequencerFeed f) const {
+    switch (f) {
+      case SequencerFeed::kMarketData: return md_queue_.Depth();
+      case SequencerFeed::kPrices: return px_queue_.Depth();
+      case SequencerFeed::kTrades: return tr_queue_.Depth();
+      case SequencerFeed::kInquiries: return iq_queue_.Depth();
+      case SequencerFeed::kCount: break;
+    }
+    return 0;
+  }
+
+  std::uint64_t Processed() const {
+    return md_queue_.Popped() + px_queue_.Popped() + tr_queue_.Popped() + iq_queue_.Popped();
+  }
+
+  // "md depth=0 max=12 done=1400 | tr ..." in priority order; full= counts pushes
+  // that had to wait for room.
+  void PrintDepths(std::ostream& os) const {
+    for (std::size_t i = 0; i < kSequencerFeedCount; ++i) {
+      const SequencerFeed f = priority_[i];
+      if (i) os << " | ";
+      os << SequencerFeedName(f);
+      switch (f) {
+        case SequencerFeed::kMarketData: PrintQueue(os, md_queue_); break;
+        case SequencerFeed::kPrices: PrintQueue(os, px_queue_); break;
+        case SequencerFeed::kTrades: PrintQueue(os, tr_queue_); break;
+        case SequencerFeed::kInquiries: PrintQueue(os, iq_queue_); break;
+        case SequencerFeed::kCount: break;
+      }
+    }
+  }
+
+ private:
+  template <typename V>
+  static void PrintQueue(std::ostream& os, const MpscQueue<Sequenced<V>>& q) {
+    os << " depth=" << q.Depth() << " max=" << q.HighWater() << " done=" << q.Popped();
+    if (q.FullWaits()) os << " full=" << q.FullWaits();
+  }
+
+  bool Poll(SequencerFeed f) {
+    switch (f) {
+      case SequencerFeed::kMarketData:
+        return Drive(f, md_queue_, [this](MarketDataMessage& m) {
+          if (auto* book = std::get_if<OrderBook<Bond>>(&m)) marketdata_.OnMessage(*book);
+          else marketdata_.OnDelta(std::get<OrderBookDelta<Bond>>(m));
+        });
+      case SequencerFeed::kPrices:
+        return Drive(f, px_queue_, [this](Price<Bond>& p) { pricing_.OnMessage(p); });
+      case SequencerFeed::kTrades:
+        return Drive(f, tr_queue_, [this](Trade<Bond>& t) { tradebooking_.OnMessage(t); });
+      case SequencerFeed::kInquiries:
+        return Drive(f, iq_queue_, [this](Inquiry<Bond>& i) { inquiry_.OnMessage(i); });
+      case SequencerFeed::kCount: break;
+    }
+    return false;
+  }
+
+  // A service error is logged and the loop carries on, as TcpInboundConnector does.
+  // Everything one message produces is stamped with one time, and measured from the
+  // message's ingress.
+  template <typename V, typename Fn>
+  static bool Drive(SequencerFeed f, MpscQueue<Sequenced<V>>& q, Fn&& fn) {
+    return q.Consume([&](Sequenced<V>& m) {
+      TimestampBatch batch;
+      LatencyScope latency(m.ingress_ns);
+      try {
+        fn(m.value);
+      } catch (const std::exception& e) {
+        std::cerr << "[Sequencer:" << SequencerFeedName(f) << "] service error: " << e.what() << "\n";
+      }
+    });
+  }
+
+  MarketDataServiceT& marketdata_;
+  PricingServiceT& pricing_;
+  TradeBookingServiceT& tradebooking_;
+  InquiryServiceT& inquiry_;
+  SequencerPriority priority_;
+  std::chrono::milliseconds report_interval_;
+
+  MpscQueue<Sequenced<MarketDataMessage>> md_queue_;
+  MpscQueue<Sequenced<Price<Bond>>> px_queue_;
+  MpscQueue<Sequenced<Trade<Bond>>> tr_queue_;
+  MpscQueue<Sequenced<Inquiry<Bond>>> iq_queue_;
+
+  QueuedMarketDataService md_in_;
+  QueuedService<Price<Bond>> px_in_;
+  QueuedService<Trade<Bond>> tr_in_;
+  QueuedService<Inquiry<Bond>> iq_in_;
+
+  std::atomic<bool> stop_{false};
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BOND_SERVICE_BRIDGES_HPP
+#define BOND_SERVICE_BRIDGES_HPP
+
+#include <string>
+
+#include "BondAlgoExecutionService.hpp"
+#include "BondAlgoStreamingService.hpp"
+#include "BondExecutionService.hpp"
+#include "BondPositionService.hpp"
+#include "BondRiskService.hpp"
+#include "BondStreamingService.hpp"
+#include "BondTradeBookingService.hpp"
+#include "soa.hpp"
+
+// Listeners that connect one service's output to the next service's input. Each is
+// templated on the downstream service so the same adapter serves the dynamically
+// wired services in main.cpp and the statically wired BondStaticPipeline.
+
+template <typename PositionServiceT = BondPositionService>
+class TradeToPositionListener final : public ServiceListener<Trade<Bond>> {
+ public:
+  explicit TradeToPositionListener(PositionServiceT& pos) : pos_(pos) {}
+  void ProcessAdd(Trade<Bond>& t) override { pos_.AddTrade(t); }
+  void ProcessUpdate(Trade<Bond>& t) override { pos_.AddTrade(t); }
+  void ProcessRemove(Trade<Bond>&) override {}
+
+ private:
+  PositionServiceT& pos_;
+};
+
+template <typename RiskServiceT = BondRiskService>
+class PositionToRiskListener final : public ServiceListener<Position<Bond>> {
+ public:
+  explicit PositionToRiskListener(RiskServiceT& risk) : risk_(risk) {}
+  void ProcessAdd(Position<Bond>& p) override { risk_.AddPosition(p); }
+  void ProcessUpdate(Position<Bond>& p) override { risk_.AddPosition(p); }
+  void ProcessRemove(Position<Bond>&) override {}
+
+ private:
+  RiskServiceT& risk_;
+};
+
+template <typename ExecutionServiceT = BondExecutionService>
+class AlgoExecToExecutionListener final : public ServiceListener<AlgoExecution> {
+ public:
+  explicit AlgoExecToExecutionListener(ExecutionServiceT& exec) : exec_(exec) {}
+  void ProcessAdd(AlgoExecution& ae) override { exec_.ExecuteOrder(ae.GetOrder(), BROKERTEC); }
+  void ProcessUpdate(AlgoExecution& ae) override { ProcessAdd(ae); }
+  void ProcessRemove(AlgoExecution&) override {}
+
+ private:
+  ExecutionServiceT& exec_;
+};
+
+template <typename StreamingServiceT = BondStreamingService>
+class AlgoStreamToStreamingListener final : public ServiceListener<AlgoStream> {
+ public:
+  explicit AlgoStreamToStreamingListener(StreamingServiceT& stream) : stream_(stream) {}
+  void ProcessAdd(AlgoStream& as) override { stream_.PublishPrice(as.GetPriceStream()); }
+  void ProcessUpdate(AlgoStream& as) override { ProcessAdd(as); }
+  void ProcessRemove(AlgoStream&) override {}
+
+ private:
+  StreamingServiceT& stream_;
+};
+
+template <typename TradeBookingServiceT = BondTradeBookingService>
+class ExecutionToTradeBookingListener final : public ServiceListener<ExecutionOrder<Bond>> {
+ public:
+  explicit ExecutionToTradeBookingListener(TradeBookingServiceT& tb) : tb_(tb) {}
+
+  void ProcessAdd(ExecutionOrder<Bond>& eo) override {
+    // Convert executions to trades so PositionService gets updated.
+    const std::string trade_id = "T" + std::to_string(seq_++);
+    const std::string book = "TRSY1";
+    Side side = (eo.GetSide() == BID ? BUY : SELL);
+    Trade<Bond> trade(eo.GetProduct(), trade_id, eo.GetPrice(), book, eo.GetVisibleQuantity(), side);
+    tb_.BookTrade(trade);
+  }
+  void ProcessUpdate(ExecutionOrder<Bond>& eo) override { ProcessAdd(eo); }
+  void ProcessRemove(ExecutionOrder<Bond>&) override {}
+
+ private:
+  TradeBookingServiceT& tb_;
+  long seq_ = 1;
+};
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef BOND_SHARDED_PIPELINE_HPP
+#define BOND_SHARDED_PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BondAlgoStreamingService.hpp"
+#include "BondInquiryService.hpp"
+#include "BondPricingService.hpp"
+#include "BondSequencer.hpp"
+#include "BondServiceBridges.hpp"
+#include "BondStaticPipeline.hpp"
+#include "BondStreamingService.hpp"
+#include "InquiryQuoteLoopbackConnector.hpp"
+#include "MpscQueue.hpp"
+#include "Timestamp.hpp"
+#include "soa.hpp"
+
+// Sharded mode: products are split across N shards (product index % N). Each shard
+// is a complete set of per-product services driven by its own BondSequencer thread,
+// so shards share no business state. What the services hand to the outside world
+// (executions, positions, risk, streams, inquiries, prices for the GUI) goes into
+// MergeQueues, and one merge thread feeds the listeners that need every product:
+// persistence and the cross-product bucketed aggregates.
+
+constexpr std::size_t kDefaultMergeQueueCapacity = 16384;
+
+// Shard side: a listener that copies each event into an MPSC queue. Merge side:
+// Drain() replays one event to the downstream listeners.
+template <typename V>
+class MergeQueue final : public ServiceListener<V> {
+ public:
+  explicit MergeQueue(std::size_t capacity = kDefaultMergeQueueCapacity) : queue_(capacity) {}
+
+  // Merge thread only; add before the shards start.
+  void AddListener(ServiceListener<V>* listener) { listeners_.push_back(listener); }
+
+  void ProcessAdd(V& data) override { queue_.Push(Event::kAdd, data); }
+  void ProcessRemove(V& data) override { queue_.Push(Event::kRemove, data); }
+  void ProcessUpdate(V& data) override { queue_.Push(Event::kUpdate, data); }
+
+  bool Drain() {
+    return queue_.Consume([this](std::pair<Event, V>& e) {
+      TimestampBatch batch;
+      for (auto* l : listeners_) {
+        switch (e.first) {
+          case Event::kAdd: l->ProcessAdd(e.second); break;
+          case Event::kRemove: l->ProcessRemove(e.second); break;
+          case Event::kUpdate: l->ProcessUpdate(e.second); break;
+        }
+      }
+    });
+  }
+
+  std::size_t Depth() const { return queue_.Depth(); }
+  std::size_t HighWater() const { return queue_.HighWater(); }
+
+ private:
+  enum class Event : std::uint8_t { kAdd, kRemove, kUpdate };
+
+  std::vector<ServiceListener<V>*> listeners_;
+  MpscQueue<std::pair<Event, V>> queue_;
+};
+
+class BondMergeStage {
+ public:
+  explicit BondMergeStage(std::size_t queue_capacity = kDefaultMergeQueueCapacity)
+      : executions(queue_capacity),
+        positions(queue_capacity),
+        risk(queue_capacity),
+        streams(queue_capacity),
+        inquiries(queue_capacity),
+        prices(queue_capacity) {}
+
+  BondMergeStage(const BondMergeStage&) = delete;
+  BondMergeStage& operator=(const BondMergeStage&) = delete;
+
+  // Merge thread: the only caller of the downstream listeners. After Stop() it
+  // handles everything still queued, then returns.
+  void Run() {
+    SpinBackoff idle;
+    while (!stop_.load(std::memory_order_acquire)) {
+      if (PollOnce()) idle = SpinBackoff();
+      else idle.Pause();
+    }
+    while (PollOnce()) {
+    }
+  }
+
+  // Stop the shards first. Release, so the final drain sees their last pushes.
+  void Stop() { stop_.store(true, std::memory_order_release); }
+
+  // One event from each non-empty queue; false if all were empty.
+  bool PollOnce() {
+    bool any = false;
+    any |= Drain(executions, "executions");
+    any |= Drain(positions, "positions");
+    any |= Drain(risk, "risk");
+    any |= Drain(streams, "streams");
+    any |= Drain(inquiries, "inquiries");
+    any |= Drain(prices, "prices");
+    return any;
+  }
+
+  // "executions depth=0 max=3 | positions ..."
+  void PrintDepths(std::ostream& os) const {
+    os << "executions";
+    PrintQueue(os, executions);
+    os << " | positions";
+    PrintQueue(os, positions);
+    os << " | risk";
+    PrintQueue(os, risk);
+    os << " | streams";
+    PrintQueue(os, streams);
+    os << " | inquiries";
+    PrintQueue(os, inquiries);
+    os << " | prices";
+    PrintQueue(os, prices);
+  }
+
+  MergeQueue<ExecutionOrder<Bond>> executions;
+  MergeQueue<Position<Bond>> positions;
+  MergeQueue<PV01<Bond>> risk;
+  MergeQueue<PriceStream<Bond>> streams;
+  MergeQueue<Inquiry<Bond>> inquiries;
+  MergeQueue<Price<Bond>> prices;
+
+ private:
+  template <typename V>
+  static void PrintQueue(std::ostream& os, const MergeQueue<V>& q) {
+    os << " depth=" << q.Depth() << " max=" << q.HighWater();
+  }
+
+  template <typename V>
+  static bool Drain(MergeQueue<V>& q, const char* name) {
+    try {
+      return q.Drain();
+    } catch (const std::exception& e) {
+      std::cerr << "[Merge:" << name << "] listener error: " << e.what() << "\n";
+      return true;
+    }
+  }
+
+  std::atomic<bool> stop_{false};
+};
+
+// One shard: the statically wired tick-to-trade chain plus pricing, streaming and
+// inquiries, with every outward-facing tail going to the merge stage. The algo
+// services alternate per product, so the output does not depend on the shard count.
+class BondShard {
+ public:
+  using Pipeline = BondStaticPipeline<MergeQueue<ExecutionOrder<Bond>>, MergeQueue<Position<Bond>>,
+                                      MergeQueue<PV01<Bond>>>;
+  using Sequencer = BondSequencer<Pipeline::MarketDataSvc, BondPricingService, Pipeline::TradeBookingSvc,
+                                  BondInquiryService>;
+
+  BondShard(BondMergeStage& merge, SequencerPriority priority, std::size_t queue_capacity)
+      : pipeline(merge.executions, merge.positions, merge.risk, AlgoAlternation::kPerProduct),
+        algo_stream(AlgoAlternation::kPerProduct),
+        algostream_to_stream(streaming),
+        inquiry_loopback(inquiry),
+        sequencer(pipeline.marketdata, pricing, pipeline.tradebooking, inquiry, priority, queue_capacity,
+                  std::chrono::milliseconds(0)) {
+    pricing.AddListener(&algo_stream);
+    pricing.AddListener(&merge.prices);
+    algo_stream.AddListener(&algostream_to_stream);
+    streaming.AddListener(&merge.streams);
+    inquiry.SetConnector(&inquiry_loopback);
+    inquiry.AddListener(&merge.inquiries);
+  }
+
+  BondShard(const BondShard&) = delete;
+  BondShard& operator=(const BondShard&) = delete;
+
+  Pipeline pipeline;
+  BondPricingService pricing;
+  BondAlgoStreamingService algo_stream;
+  BondStreamingService streaming;
+  AlgoStreamToStreamingListener<> algostream_to_stream;
+  BondInquiryService inquiry;
+  InquiryQuoteLoopbackConnector<BondInquiryService, Bond> inquiry_loopback;
+  Sequencer sequencer;
+};
+
+// Stands in for a service in an inbound connector and forwards each message to the
+// queue of the shard that owns its product. Target is one of the Queued* types.
+template <typename Target>
+class ShardRouter {
+ public:
+  explicit ShardRouter(std::vector<Target*> by_product) : by_product_(std::move(by_product)) {}
+
+  template <typename V>
+  void OnMessage(V& data) { For(data.GetProduct()).OnMessage(data); }
+
+  void OnDelta(OrderBookDelta<Bond>& delta) { For(delta.GetProduct()).OnDelta(delta); }
+
+ private:
+  Target& For(const Bond& bond) { return *by_product_[ProductIndexOf(bond)]; }
+
+  std::vector<Target*> by_product_;  // owning shard's queue, by product index
+};
+
+// N shards plus the inbound routers. Register listeners on Merge() before Start().
+class BondShardedPipeline {
+ public:
+  explicit BondShardedPipeline(std::size_t shards, SequencerPriority priority = kDefaultSequencerPriority,
+                               std::size_t queue_capacity = kDefaultSequencerQueueCapacity)
+      : shards_(MakeShards(shards == 0 ? 1 : shards, merge_, priority, queue_capacity)),
+        md_in_(Route(&BondShard::Sequencer::MarketDataInbound)),
+        px_in_(Route(&BondShard::Sequencer::PricingInbound)),
+        tr_in_(Route(&BondShard::Sequencer::TradesInbound)),
+        iq_in_(Route(&BondShard::Sequencer::InquiriesInbound)) {}
+
+  BondShardedPipeline(const BondShardedPipeline&) = delete;
+  BondShardedPipeline& operator=(const BondShardedPipeline&) = delete;
+
+  ~BondShardedPipeline() { Stop(); }
+
+  std::size_t ShardCount() const { return shards_.size(); }
+  BondShard& Shard(std::size_t i) { return *shards_[i]; }
+  BondMergeStage& Merge() { return merge_; }
+
+  // Inbound targets (any thread).
+  ShardRouter<QueuedMarketDataService>& MarketDataInbound() { return md_in_; }
+  ShardRouter<QueuedService<Price<Bond>>>& PricingInbound() { return px_in_; }
+  ShardRouter<QueuedService<Trade<Bond>>>& TradesInbound() { return tr_in_; }
+  ShardRouter<QueuedService<Inquiry<Bond>>>& InquiriesInbound() { return iq_in_; }
+
+  // One thread per shard plus the merge thread.
+  void Start() {
+    if (!threads_.empty()) return;
+    threads_.emplace_back([this] { merge_.Run(); });
+    for (auto& s : shards_) threads_.emplace_back([&s] { s->sequencer.Run(); });
+  }
+
+  // Call once the feeds have stopped. Each shard handles what is left in its input
+  // queues before its thread ends (BondSequencer::Run); then the merge thread drains
+  // everything the shards sent and stops.
+  void Stop() {
+    if (threads_.empty()) return;
+    for (auto& s : shards_) s->sequencer.Stop();
+    for (std::size_t i = 1; i < threads_.size(); ++i) threads_[i].join();
+    merge_.Stop();
+    threads_[0].join();
+    threads_.clear();
+  }
+
+  // Messages handled by all shards so far.
+  std::uint64_t Processed() const {
+    std::uint64_t n = 0;
+    for (const auto& s : shards_) n += s->sequencer.Processed();
+    return n;
+  }
+
+  void PrintDepths(std::ostream& os) const {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      os << "[Shard " << i << "] ";
+      shards_[i]->sequencer.PrintDepths(os);
+      os << "\n";
+    }
+    os << "[Merge] ";
+    merge_.PrintDepths(os);
+    os << "\n";
+  }
+
+ private:
+  static std::vector<std::unique_ptr<BondShard>> MakeShards(std::size_t n, BondMergeStage& merge,
+                                                            SequencerPriority priority, std::size_t capacity) {
+    std::vector<std::unique_ptr<BondShard>> out;
+    for (std::size_t i = 0; i < n; ++i) out.push_back(std::make_unique<BondShard>(merge, priority, capacity));
+    return out;
+  }
+
+  template <typename Target>
+  std::vector<Target*> Route(Target& (BondShard::Sequencer::*inbound)()) {
+    const std::size_t products = BondProductRepository::Instance().Size();
+    std::vector<Target*> by_product(products);
+    for (std::size_t i = 0; i < products; ++i) by_product[i] = &(shards_[i % shards_.size()]->sequencer.*inbound)();
+    return by_product;
+  }
+
+  BondMergeStage merge_;  // before the shards, which hold references into it
+  std::vector<std::unique_ptr<BondShard>> shards_;
+  ShardRouter<QueuedMarketDataService> md_in_;
+  ShardRouter<QueuedService<Price<Bond>>> px_in_;
+  ShardRouter<QueuedService<Trade<Bond>>> tr_in_;
+  ShardRouter<QueuedService<Inquiry<Bond>>> iq_in_;
+  std::vector<std::thread> threads_;
+};
+
+#endif
@@ -3,64 +3,111 @@
 
 #include <boost/asio.hpp>
 #include <functional>
+#include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
 
+#include "LatencyHistogram.hpp"
+#include "ParseStatus.hpp"
+#include "TcpIngressServer.hpp"
 #include "TcpLineSocket.hpp"
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
 #include "soa.hpp"
 
 // -------- Inbound (subscriber) connector pattern --------
 // NOTE: Connector<V> base only requires Publish(V&).
-// We add Subscribe() as a concrete method you call on the derived type.
+// We add Subscribe() (one client, own blocking thread) and Listen() (shared async
+// ingress) as concrete methods you call on the derived type.
 
 template <typename V, typename ServiceT>
 class TcpInboundConnector : public Connector<V> {
  public:
+  // parser: non-throwing TryParseXxxLine-style function; emplaces into out on kOk.
+  using Parser = std::function<ParseStatus(std::string_view, std::optional<V>&)>;
+
+  // parse_stage: the latency stage recorded once a line is parsed.
   TcpInboundConnector(ServiceT& service,
                       int listen_port,
-                      std::function<V(const std::string&)> parser)
-      : service_(service), port_(listen_port), parser_(std::move(parser)) {}
+                      Parser parser,
+                      LatencyStage parse_stage)
+      : service_(service), port_(listen_port), parser_(std::move(parser)), parse_stage_(parse_stage) {}
+
+  const FeedParseStats& Stats() const { return stats_; }
 
-  // Subscriber loop (blocking). Accepts one client connection.
+  // Subscriber loop (blocking). Accepts one client connection at a time and reads
+  // it in bulk; each line is parsed straight out of the socket buffer.
   void Subscribe() {
     boost::asio::io_context io;
     TcpLineServer server(io, port_);
 
     for (;;) {                       // accept-reaccept loop
       server.AcceptOne();
+      while (server.ReadLines([this](std::string_view line) { OnLine(line); })) {
+      }                              // peer closed => go back to AcceptOne()
 
-      while (true) {                 // read loop for that connection
-        auto lineOpt = server.ReadLine();
-        if (!lineOpt) break;         // peer closed => go back to AcceptOne()
-
-        if (lineOpt->empty()) continue;
-
-        try {
-          V obj = parser_(*lineOpt);
-          service_.OnMessage(obj);
-        } catch (const std::exception& e) {
-          std::cerr << "[InboundConnector] parse error: " << e.what()
-                    << " | line='" << *lineOpt << "'\n";
-        }
-      }
+      std::cerr << "[InboundConnector:" << port_ << "] client closed, ";
+      stats_.Print(std::cerr);
+      std::cerr << "\n";
     }
   }
 
+  // Registers the port with an asynchronous ingress instead: any number of clients
+  // may connect at once, and their lines are parsed on the ingress' event loop.
+  void Listen(TcpIngressServer& ingress) {
+    ingress.Listen(
+        port_, [this](std::string_view line) { OnLine(line); },
+        [this](const std::string& peer) {
+          std::cerr << "[InboundConnector:" << port_ << "] client " << peer << " closed, ";
+          stats_.Print(std::cerr);
+          std::cerr << "\n";
+        });
+  }
+
 void Publish(V&) override {
     // subscribe-only
   }
 
  private:
+  void OnLine(std::string_view line) {
+    if (line.empty()) return;
+
+    LatencyScope latency(LatencyIngressNs());
+    std::optional<V> obj;
+    const ParseStatus st = parser_(line, obj);
+    stats_.Record(st);
+    if (st == ParseStatus::kOk) {
+      RecordLatency(parse_stage_);
+      TimestampBatch batch;
+      try {
+        service_.OnMessage(*obj);
+      } catch (const std::exception& e) {
+        std::cerr << "[InboundConnector:" << port_ << "] service error: " << e.what()
+                  << " | line='" << line << "'\n";
+      }
+    } else {
+      std::cerr << "[InboundConnector:" << port_ << "] parse error: " << ParseStatusName(st)
+                << " | line='" << line << "'\n";
+    }
+  }
+
   ServiceT& service_;
   int port_;
-  std::function<V(const std::string&)> parser_;
+  Parser parser_;
+  LatencyStage parse_stage_;
+  FeedParseStats stats_;
 };
 
 // -------- Outbound (publisher) connector pattern --------
 template <typename V>
 class TcpOutboundConnector : public Connector<V> {
  public:
+  // serializer: SerializeXxxTo-style function appending one line (no newline) to the buffer.
+  using Serializer = std::function<void(const V&, TextBuffer&)>;
+
   TcpOutboundConnector(const std::string& host, int port,
-                       std::function<std::string(const V&)> serializer)
+                       Serializer serializer)
       : host_(host), port_(port), serializer_(std::move(serializer)) {}
 
   void Connect() {
@@ -71,13 +118,17 @@ class TcpOutboundConnector : public Connector<V> {
 
   void Publish(V& data) override {
     if (!client_) Connect();
-    client_->WriteLine(serializer_(data));
+    buf_.Clear();
+    serializer_(data, buf_);
+    buf_.Append('\n');
+    client_->Write(buf_.View());
   }
 
  private:
   std::string host_;
   int port_;
-  std::function<std::string(const V&)> serializer_;
+  Serializer serializer_;
+  TextBuffer buf_;  // reused for every message
   std::unique_ptr<boost::asio::io_context> io_;
   std::unique_ptr<TcpLineClient> client_;
 };
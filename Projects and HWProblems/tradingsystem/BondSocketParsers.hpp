@@ -1,12 +1,17 @@
 #ifndef BOND_SOCKET_PARSERS_HPP
 #define BOND_SOCKET_PARSERS_HPP
 
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "BondPriceUtils.hpp"
 #include "BondProductRepository.hpp"
 #include "CsvUtils.hpp"
+#include "ParseStatus.hpp"
+#include "TextBuffer.hpp"
 #include "executionservice.hpp"
 #include "inquiryservice.hpp"
 #include "marketdataservice.hpp"
@@ -14,127 +19,273 @@
 #include "streamingservice.hpp"
 #include "tradebookingservice.hpp"
 
+// Line parsers come in three layers:
+//   ParseXxxFields(view, f)    : never throws, never allocates; f holds string_views
+//                                into the line plus decoded numbers. Returns a ParseStatus.
+//   TryParseXxxLine(view, out) : ParseXxxFields, then emplaces the domain object into out.
+//   ParseXxxLine(line)         : throwing wrapper returning the object, for tools where a
+//                                bad line should stop the run.
+//
+// Serializers append to a caller-owned TextBuffer (SerializeXxxTo); the std::string
+// SerializeXxx forms are conveniences for tools and allocate per call.
+
+namespace bond_parse_detail {
+
+// As the feeds always have: anything but "BUY" is a sell.
+inline Side ParseSide(std::string_view s) { return s == "BUY" ? BUY : SELL; }
+
+[[noreturn]] inline void Throw(const char* what, ParseStatus st, const std::string& line) {
+  throw std::runtime_error(std::string(what) + " (" + ParseStatusName(st) + "): " + line);
+}
+
+}  // namespace bond_parse_detail
+
 // ---------- Price<Bond> ----------
-inline Price<Bond> ParsePriceLine(const std::string& line) {
+struct PriceLineFields {
+  const Bond* bond = nullptr;
+  PriceTicks mid;
+  PriceTicks spread;
+};
+
+inline ParseStatus ParsePriceFields(std::string_view line, PriceLineFields& out) {
   // productId,mid,spread
-  auto f = Split(line, ',');
-  if (f.size() != 3) throw std::runtime_error("Bad price line: " + line);
-  const Bond& b = BondProductRepository::Instance().Get(f[0]);
-  double mid = ParsePriceMaybeFractional(f[1]);
-  double spr = ParsePriceMaybeFractional(f[2]);  // allow fractional for spread too
-  return Price<Bond>(b, mid, spr);
+  std::string_view f[3];
+  if (SplitFields(line, ',', f, 3) != 3) return ParseStatus::kFieldCount;
+  out.bond = BondProductRepository::Instance().Find(f[0]);
+  if (!out.bond) return ParseStatus::kUnknownProduct;
+  if (!TryParsePriceTicks(f[1], out.mid) || !TryParsePriceTicks(f[2], out.spread)) return ParseStatus::kBadPrice;
+  return ParseStatus::kOk;
 }
 
-inline std::string SerializePrice(const Price<Bond>& p) {
+inline ParseStatus TryParsePriceLine(std::string_view line, std::optional<Price<Bond>>& out) {
+  PriceLineFields f;
+  const ParseStatus st = ParsePriceFields(line, f);
+  if (st == ParseStatus::kOk) out.emplace(*f.bond, f.mid, f.spread);
+  return st;
+}
+
+inline Price<Bond> ParsePriceLine(const std::string& line) {
+  std::optional<Price<Bond>> p;
+  const ParseStatus st = TryParsePriceLine(line, p);
+  if (st != ParseStatus::kOk) bond_parse_detail::Throw("Bad price line", st, line);
+  return *p;
+}
+
+inline void SerializePriceTo(const Price<Bond>& p, TextBuffer& out) {
   // productId,mid,spread (fractional for mid; decimal spread is ok; we do fractional too)
-  return p.GetProduct().GetProductId() + "," + FormatPriceFractional(p.GetMid()) + "," +
-         FormatPriceFractional(p.GetBidOfferSpread());
+  out.Append(p.GetProduct().GetProductId()).Append(',');
+  AppendPriceFractional(out, p.GetMid());
+  out.Append(',');
+  AppendPriceFractional(out, p.GetBidOfferSpread());
+}
+
+inline std::string SerializePrice(const Price<Bond>& p) {
+  TextBuffer buf;
+  SerializePriceTo(p, buf);
+  return buf.Str();
 }
 
 // ---------- Trade<Bond> ----------
-inline Trade<Bond> ParseTradeLine(const std::string& line) {
+struct TradeLineFields {
+  std::string_view trade_id;
+  const Bond* bond = nullptr;
+  PriceTicks price;
+  std::string_view book;
+  long quantity = 0;
+  Side side = BUY;
+};
+
+inline ParseStatus ParseTradeFields(std::string_view line, TradeLineFields& out) {
   // tradeId,productId,price,book,qty,side
-  auto f = Split(line, ',');
-  if (f.size() != 6) throw std::runtime_error("Bad trade line: " + line);
+  std::string_view f[6];
+  if (SplitFields(line, ',', f, 6) != 6) return ParseStatus::kFieldCount;
+
+  out.trade_id = f[0];
+  out.bond = BondProductRepository::Instance().Find(f[1]);
+  if (!out.bond) return ParseStatus::kUnknownProduct;
+  if (!TryParsePriceTicks(f[2], out.price)) return ParseStatus::kBadPrice;
+  out.book = f[3];
+  if (!ParseLongField(f[4], out.quantity)) return ParseStatus::kBadQuantity;
+  out.side = bond_parse_detail::ParseSide(f[5]);
+  return ParseStatus::kOk;
+}
 
-  const Bond& b = BondProductRepository::Instance().Get(f[1]);
-  double px = ParsePriceMaybeFractional(f[2]);
-  long qty = std::stol(f[4]);
-  Side side = (f[5] == "BUY") ? BUY : SELL;
-  return Trade<Bond>(b, f[0], px, f[3], qty, side);
+inline ParseStatus TryParseTradeLine(std::string_view line, std::optional<Trade<Bond>>& out) {
+  TradeLineFields f;
+  const ParseStatus st = ParseTradeFields(line, f);
+  if (st == ParseStatus::kOk)
+    out.emplace(*f.bond, std::string(f.trade_id), f.price, std::string(f.book), f.quantity, f.side);
+  return st;
+}
+
+inline Trade<Bond> ParseTradeLine(const std::string& line) {
+  std::optional<Trade<Bond>> t;
+  const ParseStatus st = TryParseTradeLine(line, t);
+  if (st != ParseStatus::kOk) bond_parse_detail::Throw("Bad trade line", st, line);
+  return *t;
+}
+
+inline void SerializeTradeTo(const Trade<Bond>& t, TextBuffer& out) {
+  out.Append(t.GetTradeId()).Append(',').Append(t.GetProduct().GetProductId()).Append(',');
+  AppendPriceFractional(out, t.GetPrice());
+  out.Append(',').Append(t.GetBook()).Append(',').AppendInt(t.GetQuantity()).Append(',');
+  out.Append(t.GetSide() == BUY ? "BUY" : "SELL");
 }
 
 inline std::string SerializeTrade(const Trade<Bond>& t) {
-  return t.GetTradeId() + "," + t.GetProduct().GetProductId() + "," + FormatPriceFractional(t.GetPrice()) + "," +
-         t.GetBook() + "," + std::to_string(t.GetQuantity()) + "," + (t.GetSide() == BUY ? "BUY" : "SELL");
+  TextBuffer buf;
+  SerializeTradeTo(t, buf);
+  return buf.Str();
 }
 
 // ---------- OrderBook<Bond> (market data) ----------
-inline OrderBook<Bond> ParseOrderBookLine(const std::string& line) {
+// Parses into caller-owned stacks (cleared first), like DecodeOrderBookWire.
+inline ParseStatus TryParseOrderBookLine(std::string_view line, const Bond*& bond,
+                                         OrderBook<Bond>::Stack& bids, OrderBook<Bond>::Stack& offers) {
   // productId|bidPx:qty;bidPx:qty;...|offerPx:qty;offerPx:qty;...
-  auto parts = Split(line, '|');
-  if (parts.size() != 3) throw std::runtime_error("Bad orderbook line: " + line);
+  std::string_view parts[3];
+  if (SplitFields(line, '|', parts, 3) != 3) return ParseStatus::kFieldCount;
 
-  const Bond& b = BondProductRepository::Instance().Get(parts[0]);
+  bond = BondProductRepository::Instance().Find(parts[0]);
+  if (!bond) return ParseStatus::kUnknownProduct;
 
-  auto parse_stack = [&](const std::string& s, PricingSide side) {
-    std::vector<Order> out;
-    if (s.empty()) return out;
-    auto lvls = Split(s, ';');
-    for (const auto& lvl : lvls) {
+  auto parse_stack = [](std::string_view s, PricingSide side, OrderBook<Bond>::Stack& out) {
+    out.clear();
+    while (!s.empty()) {
+      const std::size_t semi = s.find(';');
+      const std::string_view lvl = s.substr(0, semi);
+      s.remove_prefix(semi == std::string_view::npos ? s.size() : semi + 1);
       if (lvl.empty()) continue;
-      auto pq = Split(lvl, ':');
-      if (pq.size() != 2) throw std::runtime_error("Bad level: " + lvl);
-      double px = ParsePriceMaybeFractional(pq[0]);
-      long qty = std::stol(pq[1]);
-      out.emplace_back(px, qty, side);
+
+      const std::size_t colon = lvl.find(':');
+      if (colon == std::string_view::npos) return ParseStatus::kBadLevel;
+      PriceTicks px;
+      if (!TryParsePriceTicks(lvl.substr(0, colon), px)) return ParseStatus::kBadPrice;
+      long qty = 0;
+      if (!ParseLongField(lvl.substr(colon + 1), qty)) return ParseStatus::kBadQuantity;
+      if (out.full()) return ParseStatus::kTooDeep;
+      out.push_back(Order(px, qty, side));
     }
-    return out;
+    return ParseStatus::kOk;
   };
 
-  std::vector<Order> bids = parse_stack(parts[1], BID);
-  std::vector<Order> offers = parse_stack(parts[2], OFFER);
-  return OrderBook<Bond>(b, bids, offers);
+  const ParseStatus st = parse_stack(parts[1], BID, bids);
+  if (st != ParseStatus::kOk) return st;
+  return parse_stack(parts[2], OFFER, offers);
 }
 
-inline std::string SerializeOrderBook(const OrderBook<Bond>& ob) {
-  auto stack_to_str = [&](const std::vector<Order>& s) {
-    std::string out;
+inline OrderBook<Bond> ParseOrderBookLine(const std::string& line) {
+  const Bond* b = nullptr;
+  OrderBook<Bond>::Stack bids, offers;
+  const ParseStatus st = TryParseOrderBookLine(line, b, bids, offers);
+  if (st != ParseStatus::kOk) bond_parse_detail::Throw("Bad orderbook line", st, line);
+  return OrderBook<Bond>(*b, bids, offers);
+}
+
+inline void SerializeOrderBookTo(const OrderBook<Bond>& ob, TextBuffer& out) {
+  auto append_stack = [&](const OrderBook<Bond>::Stack& s) {
     for (size_t i = 0; i < s.size(); ++i) {
-      if (i) out += ";";
-      out += FormatPriceFractional(s[i].GetPrice());
-      out += ":";
-      out += std::to_string(s[i].GetQuantity());
+      if (i) out.Append(';');
+      AppendPriceFractional(out, s[i].GetPrice());
+      out.Append(':').AppendInt(s[i].GetQuantity());
     }
-    return out;
   };
 
-  return ob.GetProduct().GetProductId() + "|" + stack_to_str(ob.GetBidStack()) + "|" + stack_to_str(ob.GetOfferStack());
+  out.Append(ob.GetProduct().GetProductId()).Append('|');
+  append_stack(ob.GetBidStack());
+  out.Append('|');
+  append_stack(ob.GetOfferStack());
+}
+
+inline std::string SerializeOrderBook(const OrderBook<Bond>& ob) {
+  TextBuffer buf;
+  SerializeOrderBookTo(ob, buf);
+  return buf.Str();
 }
 
 // ---------- ExecutionOrder<Bond> ----------
-inline std::string SerializeExecution(const ExecutionOrder<Bond>& e) {
+inline void SerializeExecutionTo(const ExecutionOrder<Bond>& e, TextBuffer& out) {
   // productId,orderId,ordertype,price,visible,hidden,parent,isChild
   // (side omitted since base class doesn’t expose GetSide)
-  return e.GetProduct().GetProductId() + "," + e.GetOrderId() + "," + std::to_string(static_cast<int>(e.GetOrderType())) +
-         "," + FormatPriceFractional(e.GetPrice()) + "," + std::to_string(e.GetVisibleQuantity()) + "," +
-         std::to_string(e.GetHiddenQuantity()) + "," + e.GetParentOrderId() + "," + (e.IsChildOrder() ? "1" : "0");
+  out.Append(e.GetProduct().GetProductId()).Append(',').Append(e.GetOrderId()).Append(',');
+  out.AppendInt(static_cast<int>(e.GetOrderType())).Append(',');
+  AppendPriceFractional(out, e.GetPrice());
+  out.Append(',').AppendInt(e.GetVisibleQuantity()).Append(',').AppendInt(e.GetHiddenQuantity());
+  out.Append(',').Append(e.GetParentOrderId()).Append(',').Append(e.IsChildOrder() ? '1' : '0');
+}
+
+inline std::string SerializeExecution(const ExecutionOrder<Bond>& e) {
+  TextBuffer buf;
+  SerializeExecutionTo(e, buf);
+  return buf.Str();
 }
 
 // ---------- PriceStream<Bond> ----------
-inline std::string SerializePriceStream(const PriceStream<Bond>& ps) {
+inline void SerializePriceStreamTo(const PriceStream<Bond>& ps, TextBuffer& out) {
   // productId,bidPx,bidVis,bidHid,offerPx,offerVis,offerHid
-  const auto& bid = ps.GetBidOrder();
-  const auto& off = ps.GetOfferOrder();
-  return ps.GetProduct().GetProductId() + "," +
-         FormatPriceFractional(bid.GetPrice()) + "," + std::to_string(bid.GetVisibleQuantity()) + "," +
-         std::to_string(bid.GetHiddenQuantity()) + "," +
-         FormatPriceFractional(off.GetPrice()) + "," + std::to_string(off.GetVisibleQuantity()) + "," +
-         std::to_string(off.GetHiddenQuantity());
+  auto append_order = [&](const PriceStreamOrder& o) {
+    out.Append(',');
+    AppendPriceFractional(out, o.GetPrice());
+    out.Append(',').AppendInt(o.GetVisibleQuantity()).Append(',').AppendInt(o.GetHiddenQuantity());
+  };
+  out.Append(ps.GetProduct().GetProductId());
+  append_order(ps.GetBidOrder());
+  append_order(ps.GetOfferOrder());
+}
+
+inline std::string SerializePriceStream(const PriceStream<Bond>& ps) {
+  TextBuffer buf;
+  SerializePriceStreamTo(ps, buf);
+  return buf.Str();
 }
 
 // ---------- Inquiry<Bond> ----------
-inline Inquiry<Bond> ParseInquiryLine(const std::string& line) {
+struct InquiryLineFields {
+  std::string_view inquiry_id;
+  const Bond* bond = nullptr;
+  Side side = BUY;
+  long quantity = 0;
+  PriceTicks price;
+  InquiryState state = RECEIVED;
+};
+
+inline ParseStatus ParseInquiryFields(std::string_view line, InquiryLineFields& out) {
   // inquiryId,productId,side,qty,price,state
-  auto f = Split(line, ',');
-  if (f.size() != 6) throw std::runtime_error("Bad inquiry line: " + line);
+  std::string_view f[6];
+  if (SplitFields(line, ',', f, 6) != 6) return ParseStatus::kFieldCount;
 
-  const Bond& b = BondProductRepository::Instance().Get(f[1]);
-  Side side = (f[2] == "BUY") ? BUY : SELL;
-  long qty = std::stol(f[3]);
-  double px = ParsePriceMaybeFractional(f[4]);
+  out.inquiry_id = f[0];
+  out.bond = BondProductRepository::Instance().Find(f[1]);
+  if (!out.bond) return ParseStatus::kUnknownProduct;
+  out.side = bond_parse_detail::ParseSide(f[2]);
+  if (!ParseLongField(f[3], out.quantity)) return ParseStatus::kBadQuantity;
+  if (!TryParsePriceTicks(f[4], out.price)) return ParseStatus::kBadPrice;
 
-  InquiryState st = RECEIVED;
-  if (f[5] == "RECEIVED") st = RECEIVED;
-  else if (f[5] == "QUOTED") st = QUOTED;
-  else if (f[5] == "DONE") st = DONE;
-  else if (f[5] == "REJECTED") st = REJECTED;
-  else if (f[5] == "CUSTOMER_REJECTED") st = CUSTOMER_REJECTED;
+  // An unknown state is taken as RECEIVED, as the feed always has.
+  if (f[5] == "QUOTED") out.state = QUOTED;
+  else if (f[5] == "DONE") out.state = DONE;
+  else if (f[5] == "REJECTED") out.state = REJECTED;
+  else if (f[5] == "CUSTOMER_REJECTED") out.state = CUSTOMER_REJECTED;
+  else out.state = RECEIVED;
+  return ParseStatus::kOk;
+}
 
-  return Inquiry<Bond>(f[0], b, side, qty, px, st);
+inline ParseStatus TryParseInquiryLine(std::string_view line, std::optional<Inquiry<Bond>>& out) {
+  InquiryLineFields f;
+  const ParseStatus st = ParseInquiryFields(line, f);
+  if (st == ParseStatus::kOk)
+    out.emplace(std::string(f.inquiry_id), *f.bond, f.side, f.quantity, f.price, f.state);
+  return st;
 }
 
-inline std::string SerializeInquiry(const Inquiry<Bond>& i) {
+inline Inquiry<Bond> ParseInquiryLine(const std::string& line) {
+  std::optional<Inquiry<Bond>> i;
+  const ParseStatus st = TryParseInquiryLine(line, i);
+  if (st != ParseStatus::kOk) bond_parse_detail::Throw("Bad inquiry line", st, line);
+  return *i;
+}
+
+inline void SerializeInquiryTo(const Inquiry<Bond>& i, TextBuffer& out) {
   auto st = [&](InquiryState s) {
     switch (s) {
       case RECEIVED: return "RECEIVED";
@@ -146,9 +297,16 @@ inline std::string SerializeInquiry(const Inquiry<Bond>& i) {
     return "RECEIVED";
   };
 
-  return i.GetInquiryId() + "," + i.GetProduct().GetProductId() + "," +
-         (i.GetSide() == BUY ? "BUY" : "SELL") + "," + std::to_string(i.GetQuantity()) + "," +
-         FormatPriceFractional(i.GetPrice()) + "," + st(i.GetState());
+  out.Append(i.GetInquiryId()).Append(',').Append(i.GetProduct().GetProductId()).Append(',');
+  out.Append(i.GetSide() == BUY ? "BUY" : "SELL").Append(',').AppendInt(i.GetQuantity()).Append(',');
+  AppendPriceFractional(out, i.GetPrice());
+  out.Append(',').Append(st(i.GetState()));
+}
+
+inline std::string SerializeInquiry(const Inquiry<Bond>& i) {
+  TextBuffer buf;
+  SerializeInquiryTo(i, buf);
+  return buf.Str();
 }
 
 #endif
@@ -0,0 +1,70 @@
+#ifndef BOND_STATIC_PIPELINE_HPP
+#define BOND_STATIC_PIPELINE_HPP
+
+#include "BondAlgoExecutionService.hpp"
+#include "BondExecutionService.hpp"
+#include "BondMarketDataService.hpp"
+#include "BondPositionService.hpp"
+#include "BondRiskService.hpp"
+#include "BondServiceBridges.hpp"
+#include "BondTradeBookingService.hpp"
+#include "soa.hpp"
+
+// The tick-to-trade chain wired at compile time:
+//
+//   MarketData -> AlgoExecution -> Execution -> TradeBooking -> Position -> Risk
+//
+// Every hop is a direct call on a concrete (final) type, so the compiler can inline
+// the chain instead of making a virtual call through ServiceListener at each stage.
+// The tails receive what each stage also hands to the outside world (persistence,
+// publishing): any listener type, or a FanoutListener for several.
+//
+// Stages are members built leaf-first, since each one binds references to the
+// stages after it; the object cannot be moved. Every service still accepts
+// AddListener for extra, dynamically dispatched listeners.
+template <typename ExecutionTail, typename PositionTail, typename RiskTail>
+class BondStaticPipeline {
+ public:
+  using RiskSvc = BasicBondRiskService<StaticListeners<PV01<Bond>, RiskTail>>;
+  using PositionToRisk = PositionToRiskListener<RiskSvc>;
+  using PositionSvc = BasicBondPositionService<StaticListeners<Position<Bond>, PositionToRisk, PositionTail>>;
+  using TradeToPosition = TradeToPositionListener<PositionSvc>;
+  using TradeBookingSvc = BasicBondTradeBookingService<StaticListeners<Trade<Bond>, TradeToPosition>>;
+  using ExecutionToTradeBooking = ExecutionToTradeBookingListener<TradeBookingSvc>;
+  using ExecutionSvc =
+      BasicBondExecutionService<StaticListeners<ExecutionOrder<Bond>, ExecutionToTradeBooking, ExecutionTail>>;
+  using AlgoExecToExecution = AlgoExecToExecutionListener<ExecutionSvc>;
+  using AlgoExecutionSvc = BasicBondAlgoExecutionService<StaticListeners<AlgoExecution, AlgoExecToExecution>>;
+  using MarketDataSvc = BasicBondMarketDataService<StaticListeners<OrderBook<Bond>, AlgoExecutionSvc>>;
+
+  BondStaticPipeline(ExecutionTail& execution_tail, PositionTail& position_tail, RiskTail& risk_tail,
+                     AlgoAlternation alternation = AlgoAlternation::kGlobal)
+      : risk(StaticListeners<PV01<Bond>, RiskTail>(risk_tail)),
+        position_to_risk(risk),
+        position(StaticListeners<Position<Bond>, PositionToRisk, PositionTail>(position_to_risk, position_tail)),
+        trade_to_position(position),
+        tradebooking(StaticListeners<Trade<Bond>, TradeToPosition>(trade_to_position)),
+        execution_to_tradebooking(tradebooking),
+        execution(StaticListeners<ExecutionOrder<Bond>, ExecutionToTradeBooking, ExecutionTail>(
+            execution_to_tradebooking, execution_tail)),
+        algo_to_execution(execution),
+        algo_execution(StaticListeners<AlgoExecution, AlgoExecToExecution>(algo_to_execution), alternation),
+        marketdata(StaticListeners<OrderBook<Bond>, AlgoExecutionSvc>(algo_execution)) {}
+
+  BondStaticPipeline(const BondStaticPipeline&) = delete;
+  BondStaticPipeline& operator=(const BondStaticPipeline&) = delete;
+
+  // Leaf first; see above. The bridges are only used by the stages on either side.
+  RiskSvc risk;
+  PositionToRisk position_to_risk;
+  PositionSvc position;
+  TradeToPosition trade_to_position;
+  TradeBookingSvc tradebooking;
+  ExecutionToTradeBooking execution_to_tradebooking;
+  ExecutionSvc execution;
+  AlgoExecToExecution algo_to_execution;
+  AlgoExecutionSvc algo_execution;
+  MarketDataSvc marketdata;
+};
+
+#endif
@@ -1,10 +1,11 @@
 #ifndef BOND_STREAMING_SERVICE_HPP
 #define BOND_STREAMING_SERVICE_HPP
 
-#include <map>
 #include <string>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
+#include "ProductTable.hpp"
 #include "products.hpp"
 #include "soa.hpp"
 #include "streamingservice.hpp"
@@ -18,7 +19,7 @@ public:
         pub_connector_ = connector;
     }
 
-    PriceStream<Bond>& GetData(std::string key) override { return streams_.at(key); }
+    PriceStream<Bond>& GetData(std::string key) override { return streams_.At(key); }
 
     void OnMessage(PriceStream<Bond>&) override 
     {
@@ -37,21 +38,19 @@ public:
 
     void PublishPrice(const PriceStream<Bond>& priceStream) override 
     {
-        const std::string pid = priceStream.GetProduct().GetProductId();
-        streams_.erase(pid);
-        streams_.emplace(pid, PriceStream<Bond>(priceStream.GetProduct(),
-                                            priceStream.GetBidOrder(),
-                                            priceStream.GetOfferOrder()));
-
-
-        PriceStream<Bond>& stored = streams_.at(pid);
+        RecordLatency(LatencyStage::kStreaming);
+        PriceStream<Bond>& stored = streams_.Emplace(ProductIndexOf(priceStream.GetProduct()),
+                                                     priceStream.GetProduct(),
+                                                     priceStream.GetBidOrder(),
+                                                     priceStream.GetOfferOrder());
         for (auto* l : listeners_) l->ProcessAdd(stored);
 
+        RecordLatency(LatencyStage::kStreamingOut);
         if (pub_connector_) pub_connector_->Publish(stored);
     }
 
 private:
-    std::map<std::string, PriceStream<Bond>> streams_;
+    ProductTable<PriceStream<Bond>> streams_;
     std::vector<ServiceListener<PriceStream<Bond>>*> listeners_;
     Connector<PriceStream<Bond>>* pub_connector_ = nullptr;
 };
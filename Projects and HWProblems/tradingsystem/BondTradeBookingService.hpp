@@ -3,41 +3,48 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "LatencyHistogram.hpp"
 #include "products.hpp"
 #include "soa.hpp"
 #include "tradebookingservice.hpp"
 
-class BondTradeBookingService final : public TradeBookingService<Bond> {
+// Listeners: DynamicListeners<Trade<Bond>> or StaticListeners<Trade<Bond>, ...> (soa.hpp).
+template <typename Listeners = DynamicListeners<Trade<Bond>>>
+class BasicBondTradeBookingService final : public TradeBookingService<Bond> {
 public:
-    BondTradeBookingService() = default;
+    explicit BasicBondTradeBookingService(Listeners listeners = Listeners()) : listeners_(std::move(listeners)) {}
 
     Trade<Bond>& GetData(std::string key) override { return trades_.at(key); }
 
     void OnMessage(Trade<Bond>& data) override 
     {
+        RecordLatency(LatencyStage::kTradeBooking);
         auto key = data.GetTradeId();
         trades_.erase(key);
         trades_.emplace(key, Trade<Bond>(data.GetProduct(), data.GetTradeId(),
                                  data.GetPrice(), data.GetBook(),
                                  data.GetQuantity(), data.GetSide()));
 
-        for (auto* l : listeners_) l->ProcessAdd(trades_.at(data.GetTradeId()));
+        Trade<Bond>& stored = trades_.at(data.GetTradeId());
+        listeners_.ForEach([&](auto& l) { l.ProcessAdd(stored); });
     }
 
     void AddListener(ServiceListener<Trade<Bond>>* listener) override 
     {
-        listeners_.push_back(listener);
+        listeners_.Add(listener);
     }
 
     const std::vector<ServiceListener<Trade<Bond>>*>& GetListeners() const override 
     {
-        return listeners_;
+        return listeners_.Get();
     }
 
     void BookTrade(const Trade<Bond>& trade) override 
     {
+        RecordLatency(LatencyStage::kTradeBooking);
         const std::string key = trade.GetTradeId();
         trades_.erase(key);
         trades_.emplace(key, Trade<Bond>(trade.GetProduct(),
@@ -48,12 +55,14 @@ public:
                                         trade.GetSide()));
 
         Trade<Bond>& stored = trades_.at(trade.GetTradeId());
-        for (auto* l : listeners_) l->ProcessAdd(stored);
+        listeners_.ForEach([&](auto& l) { l.ProcessAdd(stored); });
     }
 
 private:
     std::map<std::string, Trade<Bond>> trades_;
-    std::vector<ServiceListener<Trade<Bond>>*> listeners_;
+    Listeners listeners_;
 };
 
+using BondTradeBookingService = BasicBondTradeBookingService<>;
+
 #endif
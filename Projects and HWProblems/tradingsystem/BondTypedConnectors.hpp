@@ -1,6 +1,7 @@
 #ifndef BOND_TYPED_CONNECTORS_HPP
 #define BOND_TYPED_CONNECTORS_HPP
 
+#include "AsyncTcpOutboundConnector.hpp"
 #include "BondSocketConnectors.hpp"
 #include "BondSocketParsers.hpp"
 
@@ -8,39 +9,50 @@
 template <typename PricingServiceT>
 inline TcpInboundConnector<Price<Bond>, PricingServiceT>
 MakePricingInbound(PricingServiceT& svc, int port) {
-  return TcpInboundConnector<Price<Bond>, PricingServiceT>(svc, port, ParsePriceLine);
+  return TcpInboundConnector<Price<Bond>, PricingServiceT>(svc, port, TryParsePriceLine, LatencyStage::kPxParse);
 }
 
 // Trades inbound (socket -> BondTradeBookingService::OnMessage)
 template <typename TradeBookingServiceT>
 inline TcpInboundConnector<Trade<Bond>, TradeBookingServiceT>
 MakeTradesInbound(TradeBookingServiceT& svc, int port) {
-  return TcpInboundConnector<Trade<Bond>, TradeBookingServiceT>(svc, port, ParseTradeLine);
+  return TcpInboundConnector<Trade<Bond>, TradeBookingServiceT>(svc, port, TryParseTradeLine, LatencyStage::kTrParse);
 }
 
 // Inquiries inbound (socket -> BondInquiryService::OnMessage)
 template <typename InquiryServiceT>
 inline TcpInboundConnector<Inquiry<Bond>, InquiryServiceT>
 MakeInquiriesInbound(InquiryServiceT& svc, int port) {
-  return TcpInboundConnector<Inquiry<Bond>, InquiryServiceT>(svc, port, ParseInquiryLine);
+  return TcpInboundConnector<Inquiry<Bond>, InquiryServiceT>(svc, port, TryParseInquiryLine, LatencyStage::kIqParse);
 }
 
 // Execution outbound (BondExecutionService publishes -> socket)
 inline TcpOutboundConnector<ExecutionOrder<Bond>>
 MakeExecutionOutbound(const std::string& host, int port) {
-  return TcpOutboundConnector<ExecutionOrder<Bond>>(host, port, SerializeExecution);
+  return TcpOutboundConnector<ExecutionOrder<Bond>>(host, port, SerializeExecutionTo);
 }
 
 // Streaming outbound (BondStreamingService publishes -> socket)
 inline TcpOutboundConnector<PriceStream<Bond>>
 MakeStreamingOutbound(const std::string& host, int port) {
-  return TcpOutboundConnector<PriceStream<Bond>>(host, port, SerializePriceStream);
+  return TcpOutboundConnector<PriceStream<Bond>>(host, port, SerializePriceStreamTo);
 }
 
 // Inquiry outbound (BondInquiryService sends quote/state updates -> socket)
 inline TcpOutboundConnector<Inquiry<Bond>>
 MakeInquiryOutbound(const std::string& host, int port) {
-  return TcpOutboundConnector<Inquiry<Bond>>(host, port, SerializeInquiry);
+  return TcpOutboundConnector<Inquiry<Bond>>(host, port, SerializeInquiryTo);
+}
+
+// Asynchronous outbound variants (socket writes on the connector's own thread)
+inline AsyncTcpOutboundConnector<ExecutionOrder<Bond>>
+MakeAsyncExecutionOutbound(const std::string& host, int port, OutboundOptions options = OutboundOptions()) {
+  return AsyncTcpOutboundConnector<ExecutionOrder<Bond>>(host, port, SerializeExecutionTo, options);
+}
+
+inline AsyncTcpOutboundConnector<PriceStream<Bond>>
+MakeAsyncStreamingOutbound(const std::string& host, int port, OutboundOptions options = OutboundOptions()) {
+  return AsyncTcpOutboundConnector<PriceStream<Bond>>(host, port, SerializePriceStreamTo, options);
 }
 
 #endif
@@ -1,8 +1,12 @@
 #ifndef CSV_UTILS_HPP
 #define CSV_UTILS_HPP
 
+#include <charconv>
+#include <cstddef>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
 inline std::vector<std::string> Split(const std::string& s, char delim) {
@@ -13,4 +17,27 @@ inline std::vector<std::string> Split(const std::string& s, char delim) {
   return out;
 }
 
+// Allocation-free split: views into s go to out[0..max_fields). Returns the number of
+// fields found, or max_fields + 1 if there are more (callers treat that as a count
+// mismatch). Empty fields are kept, except that a trailing delimiter does not add an
+// empty last field, matching Split.
+inline std::size_t SplitFields(std::string_view s, char delim, std::string_view* out, std::size_t max_fields) {
+  std::size_t n = 0;
+  while (!s.empty()) {
+    const std::size_t pos = s.find(delim);
+    if (n == max_fields) return max_fields + 1;
+    out[n++] = s.substr(0, pos);
+    if (pos == std::string_view::npos) break;
+    s.remove_prefix(pos + 1);
+  }
+  return n;
+}
+
+// Whole field must be a decimal integer.
+inline bool ParseLongField(std::string_view s, long& out) {
+  const char* end = s.data() + s.size();
+  auto [p, ec] = std::from_chars(s.data(), end, out);
+  return ec == std::errc() && p == end && !s.empty();
+}
+
 #endif
@@ -1,185 +1,290 @@
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
-#include <stdexcept>
 
+#include "BondMarketDataWire.hpp"
 #include "BondPriceUtils.hpp"
+#include "BondUniverse.hpp"
+#include "TextBuffer.hpp"
 
-// Generates the input text files used by the project:
+// Generates the input files used by the project:
 //   prices.txt      : "productId,mid,spread"   (mid/spread in fractional bond format)
 //   trades.txt      : "tradeId,productId,price,book,quantity,side"
 //   inquiries.txt   : "inquiryId,productId,side,quantity,price,state"
 //   marketdata.txt  : "productId|bidPx:qty;...|offerPx:qty;..." (5 levels each side)
+//   marketdata.bin  : with --binary, instead of marketdata.txt: the same books as
+//                     MdBookWire snapshot records back to back (md_shm_publisher
+//                     reads them without parsing)
+//
+// Every row is a closed-form function of (product, row), so the rows are cut into
+// blocks that the threads format round-robin into their own buffers; blocks are
+// written in order, in one fwrite each.
+//
+// By default products are interleaved in time: row i of every product, then row
+// i + 1. --by_product writes all 2Y rows, then 3Y, and so on. --timestamps[=US]
+// prefixes each text line with "<offset_us>\t" (row i of a product at i * US,
+// products staggered within that) for the publishers' --timestamps replay.
+
+namespace
+{
+
+constexpr std::uint64_t kBlockRows = 16384;
 
-static std::vector<std::string> Products()
+struct GenOptions
 {
-  return {"2Y", "3Y", "5Y", "7Y", "10Y", "20Y", "30Y"};
+  long n = 1000;  // rows per product (prices, market data)
+  unsigned threads = 1;
+  bool by_product = false;
+  bool binary = false;
+  long timestamp_us = 0;  // 0: no timestamps
+};
+
+const std::vector<std::string>& Products()
+{
+  static const std::vector<std::string> products = {"2Y", "3Y", "5Y", "7Y", "10Y", "20Y", "30Y"};
+  return products;
 }
 
-static double Tick256() { return 1.0 / 256.0; }
+double Tick256() { return 1.0 / 256.0; }
 
-// ---------- prices.txt ----------
-static void GenPrices(const std::string& file, long N_per_product)
+// Mid walks from 99 up to 101 and back by 1/256 (period 1024 rows).
+double Mid(long i)
 {
-  std::ofstream out(file);
-  if (!out.is_open()) throw std::runtime_error("Unable to open " + file);
+  const long k = i % 1024;
+  return 99.0 + static_cast<double>(k <= 512 ? k : 1024 - k) * Tick256();
+}
 
-  auto prods = Products();
+// Spread walks 1/128, 3/256, 1/64, 3/256, ... (period 4 rows).
+double Spread(long i)
+{
+  static const int steps[4] = {0, 1, 2, 1};
+  return static_cast<double>(2 + steps[i % 4]) * Tick256();
+}
 
-  // Oscillate mid between 99 and 101 by 1/256.
-  // Spread oscillates between 1/128 and 1/64 by 1/256.
-  for (const auto& pid : prods)
-  {
-    double mid = 99.0;
-    bool up = true;
+void AppendPrice(TextBuffer& buf, double px) { AppendPriceFractional(buf, PriceTicks::FromDouble(px)); }
 
-    double spr = 1.0 / 128.0;
-    bool spr_up = true;
+// "<offset_us>\t" for row i of product p; rows of one product are stride rows of the
+// price timeline apart.
+void AppendTimestamp(TextBuffer& buf, std::size_t p, long i, long stride, const GenOptions& o)
+{
+  if (!o.timestamp_us) return;
+  const long long slot = static_cast<long long>(i) * stride * o.timestamp_us;
+  buf.AppendInt(slot + static_cast<long long>(p) * o.timestamp_us / static_cast<long long>(Products().size()));
+  buf.Append('\t');
+}
 
-    for (long i = 0; i < N_per_product; ++i)
+// Writes rows_per_product rows for every product to file; row(buf, product, i)
+// appends one. Returns the bytes written.
+template <typename Row>
+std::uint64_t WriteRows(const std::string& file, long rows_per_product, const GenOptions& o, Row&& row)
+{
+  std::FILE* out = std::fopen(file.c_str(), "wb");
+  if (!out) throw std::runtime_error("Unable to open " + file);
+
+  const std::uint64_t products = Products().size();
+  const std::uint64_t per_product = static_cast<std::uint64_t>(rows_per_product);
+  const std::uint64_t total = per_product * products;
+  const std::uint64_t blocks = (total + kBlockRows - 1) / kBlockRows;
+
+  std::mutex mutex;
+  std::condition_variable turn;
+  std::uint64_t next_block = 0;  // next block to write
+  std::uint64_t bytes = 0;
+  bool failed = false;
+
+  auto worker = [&](std::uint64_t first) {
+    TextBuffer buf(1 << 20);
+    for (std::uint64_t b = first; b < blocks; b += o.threads)
     {
-      out << pid << ","
-          << FormatPriceFractional(mid) << ","
-          << FormatPriceFractional(spr) << "\n";
-
-      // mid move
-      mid += up ? Tick256() : -Tick256();
-      if (mid >= 101.0) up = false;
-      if (mid <= 99.0) up = true;
-
-      // spread move
-      spr += spr_up ? Tick256() : -Tick256();
-      if (spr >= 1.0 / 64.0) spr_up = false;
-      if (spr <= 1.0 / 128.0) spr_up = true;
+      buf.Clear();
+      const std::uint64_t end = std::min(total, (b + 1) * kBlockRows);
+      for (std::uint64_t g = b * kBlockRows; g < end; ++g)
+      {
+        const std::uint64_t p = o.by_product ? g / per_product : g % products;
+        const std::uint64_t i = o.by_product ? g % per_product : g / products;
+        row(buf, static_cast<std::size_t>(p), static_cast<long>(i));
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+      turn.wait(lock, [&] { return next_block == b; });
+      if (std::fwrite(buf.Data(), 1, buf.Size(), out) != buf.Size()) failed = true;
+      bytes += buf.Size();
+      ++next_block;
+      turn.notify_all();
     }
-  }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < o.threads; ++t) threads.emplace_back(worker, t);
+  worker(0);
+  for (auto& t : threads) t.join();
+
+  if (std::fclose(out) != 0 || failed) throw std::runtime_error("Error writing " + file);
+  return bytes;
 }
 
-// ---------- trades.txt ----------
-static void GenTrades(const std::string& file)
+// ---------- prices.txt ----------
+std::uint64_t GenPrices(const std::string& file, const GenOptions& o)
 {
-  std::ofstream out(file);
-  if (!out.is_open()) throw std::runtime_error("Unable to open " + file);
-
-  auto prods = Products();
-  std::vector<std::string> books = {"TRSY1", "TRSY2", "TRSY3"};
+  return WriteRows(file, o.n, o, [&](TextBuffer& buf, std::size_t p, long i) {
+    AppendTimestamp(buf, p, i, 1, o);
+    buf.Append(Products()[p]).Append(',');
+    AppendPrice(buf, Mid(i));
+    buf.Append(',');
+    AppendPrice(buf, Spread(i));
+    buf.Append('\n');
+  });
+}
 
-  // 10 trades per product, alternating BUY/SELL, quantities cycle 1..5mm.
-  long tid = 1;
-  for (const auto& pid : prods)
-  {
-    for (int i = 0; i < 10; ++i)
-    {
-      bool buy = (i % 2 == 0);
-      long qty = (1 + (i % 5)) * 1000000L;
-      double px = buy ? 99.0 : 100.0;
-      const std::string& book = books[static_cast<std::size_t>(i) % books.size()];
-
-      out << "T" << tid++ << ","
-          << pid << ","
-          << FormatPriceFractional(px) << ","
-          << book << ","
-          << qty << ","
-          << (buy ? "BUY" : "SELL") << "\n";
-    }
-  }
+// ---------- trades.txt ----------
+// 10 trades per product, alternating BUY/SELL, quantities cycle 1..5mm; spread
+// over the price timeline when timestamped.
+std::uint64_t GenTrades(const std::string& file, const GenOptions& o)
+{
+  static const char* const books[] = {"TRSY1", "TRSY2", "TRSY3"};
+  const long stride = std::max(1L, o.n / 10);
+  return WriteRows(file, 10, o, [&](TextBuffer& buf, std::size_t p, long i) {
+    const bool buy = (i % 2 == 0);
+    AppendTimestamp(buf, p, i, stride, o);
+    buf.Append('T').AppendInt(static_cast<long long>(p) * 10 + i + 1).Append(',');
+    buf.Append(Products()[p]).Append(',');
+    AppendPrice(buf, buy ? 99.0 : 100.0);
+    buf.Append(',').Append(books[i % 3]).Append(',');
+    buf.AppendInt((1 + (i % 5)) * 1000000L).Append(',');
+    buf.Append(buy ? "BUY" : "SELL").Append('\n');
+  });
 }
 
 // ---------- inquiries.txt ----------
-static void GenInquiries(const std::string& file)
+// 10 inquiries per product with state RECEIVED, price 100-000.
+std::uint64_t GenInquiries(const std::string& file, const GenOptions& o)
 {
-  std::ofstream out(file);
-  if (!out.is_open()) throw std::runtime_error("Unable to open " + file);
-
-  auto prods = Products();
-
-  // 10 inquiries per product with state RECEIVED.
-  long iid = 1;
-  for (const auto& pid : prods)
-  {
-    for (int i = 0; i < 10; ++i)
-    {
-      bool buy = (i % 2 == 0);
-      long qty = (1 + (i % 5)) * 1000000L;
-
-      // Keep inquiry "price" at 100-000 initially.
-      out << "I" << iid++ << ","
-          << pid << ","
-          << (buy ? "BUY" : "SELL") << ","
-          << qty << ","
-          << "100-000" << ","
-          << "RECEIVED" << "\n";
-    }
-  }
+  const long stride = std::max(1L, o.n / 10);
+  return WriteRows(file, 10, o, [&](TextBuffer& buf, std::size_t p, long i) {
+    const bool buy = (i % 2 == 0);
+    AppendTimestamp(buf, p, i, stride, o);
+    buf.Append('I').AppendInt(static_cast<long long>(p) * 10 + i + 1).Append(',');
+    buf.Append(Products()[p]).Append(',');
+    buf.Append(buy ? "BUY" : "SELL").Append(',');
+    buf.AppendInt((1 + (i % 5)) * 1000000L).Append(",100-000,RECEIVED\n");
+  });
 }
 
-// ---------- marketdata.txt ----------
-static void GenMarketData(const std::string& file, long N_per_product)
+// ---------- marketdata.txt / marketdata.bin ----------
+// 5 levels deep, sizes 10..50mm; top-of-book spread cycles 1/128, 1/64, 3/128,
+// 1/32, 3/128, 1/64 and widens by 1/256 per level.
+std::uint64_t GenMarketData(const std::string& file, const GenOptions& o)
 {
-  std::ofstream out(file);
-  if (!out.is_open()) throw std::runtime_error("Unable to open " + file);
-
-  auto prods = Products();
-
-  // 5 levels deep; sizes: 10,20,30,40,50mm
-  const std::vector<long> sizes = {10000000, 20000000, 30000000, 40000000, 50000000};
-
-  // top-of-book spread cycles: 1/128, 1/64, 3/128, 1/32, 3/128, 1/64, ...
-  const std::vector<double> spreads = {
-      1.0 / 128.0,
-      1.0 / 64.0,
-      3.0 / 128.0,
-      1.0 / 32.0,
-      3.0 / 128.0,
-      1.0 / 64.0
-  };
+  static const long sizes[5] = {10000000, 20000000, 30000000, 40000000, 50000000};
+  static const double spreads[6] = {1.0 / 128.0, 1.0 / 64.0, 3.0 / 128.0, 1.0 / 32.0, 3.0 / 128.0, 1.0 / 64.0};
 
-  for (const auto& pid : prods)
-  {
-    double mid = 99.0;
-    bool up = true;
-    std::size_t sp_idx = 0;
+  std::vector<std::uint32_t> product_index;
+  for (const auto& pid : Products())
+    product_index.push_back(static_cast<std::uint32_t>(
+        BondProductRepository::Instance().IndexOf(BondProductRepository::Instance().Get(pid))));
 
-    for (long i = 0; i < N_per_product; ++i)
-    {
-      double top_sp = spreads[sp_idx];
-      sp_idx = (sp_idx + 1) % spreads.size();
+  return WriteRows(file, o.n, o, [&](TextBuffer& buf, std::size_t p, long i) {
+    const double mid = Mid(i);
+    const double top_sp = spreads[i % 6];
 
-      std::string bid_stack, off_stack;
+    if (o.binary)
+    {
+      MdBookWire rec;
+      rec.magic = kMdBookWireMagic;
+      rec.product_index = product_index[p];
+      rec.bid_count = 5;
+      rec.offer_count = 5;
+      rec.seq = static_cast<std::uint32_t>(i);
       for (int lvl = 0; lvl < 5; ++lvl)
       {
-        // widen by 1/256 each level away from top-of-book
-        double level_sp = top_sp + lvl * Tick256();
-        double bpx = mid - level_sp / 2.0;
-        double opx = mid + level_sp / 2.0;
-
-        if (lvl) { bid_stack += ";"; off_stack += ";"; }
-
-        bid_stack += FormatPriceFractional(bpx) + ":" + std::to_string(sizes[static_cast<std::size_t>(lvl)]);
-        off_stack += FormatPriceFractional(opx) + ":" + std::to_string(sizes[static_cast<std::size_t>(lvl)]);
+        const double level_sp = top_sp + lvl * Tick256();
+        rec.levels[lvl] = MdLevelWire{PriceTicks::FromDouble(mid - level_sp / 2.0).Ticks(), sizes[lvl]};
+        rec.levels[5 + lvl] = MdLevelWire{PriceTicks::FromDouble(mid + level_sp / 2.0).Ticks(), sizes[lvl]};
       }
+      buf.Append(std::string_view(reinterpret_cast<const char*>(&rec), MdBookWireSize(10)));
+      return;
+    }
 
-      out << pid << "|" << bid_stack << "|" << off_stack << "\n";
-
-      // mid move
-      mid += up ? Tick256() : -Tick256();
-      if (mid >= 101.0) up = false;
-      if (mid <= 99.0) up = true;
+    AppendTimestamp(buf, p, i, 1, o);
+    buf.Append(Products()[p]);
+    for (int side = 0; side < 2; ++side)
+    {
+      buf.Append('|');
+      for (int lvl = 0; lvl < 5; ++lvl)
+      {
+        const double level_sp = top_sp + lvl * Tick256();
+        if (lvl) buf.Append(';');
+        AppendPrice(buf, side == 0 ? mid - level_sp / 2.0 : mid + level_sp / 2.0);
+        buf.Append(':').AppendInt(sizes[lvl]);
+      }
     }
-  }
+    buf.Append('\n');
+  });
 }
 
+}  // namespace
+
+// Usage: ./gen_data [N] [--threads=T] [--by_product] [--timestamps[=US]] [--binary]
+//   N            rows per product for prices and market data (default 1000)
+//   --threads    formatting threads (default: hardware threads)
+//   --by_product all rows of one product before the next (the original layout)
+//   --timestamps "<offset_us>\t" line prefixes, rows US apart (default 100)
+//   --binary     market data as marketdata.bin (MdBookWire records) instead of text
 int main(int argc, char** argv)
 {
-  long N = 1000; // demo; set to 1000000 for full assignment
-  if (argc > 1) N = std::stol(argv[1]);
+  GenOptions o;
+  o.threads = std::max(1u, std::thread::hardware_concurrency());
+  try
+  {
+    for (int a = 1; a < argc; ++a)
+    {
+      const std::string arg = argv[a];
+      if (arg.rfind("--threads=", 0) == 0) o.threads = std::max(1ul, std::stoul(arg.substr(10)));
+      else if (arg == "--by_product") o.by_product = true;
+      else if (arg == "--timestamps") o.timestamp_us = 100;
+      else if (arg.rfind("--timestamps=", 0) == 0) o.timestamp_us = std::stol(arg.substr(13));
+      else if (arg == "--binary") o.binary = true;
+      else if (arg.rfind("--", 0) == 0) throw std::invalid_argument("Unknown option " + arg);
+      else o.n = std::stol(arg);
+    }
+    if (o.n < 0 || o.timestamp_us < 0) throw std::invalid_argument("N and --timestamps must not be negative");
+    if (o.timestamp_us && o.by_product)
+      throw std::invalid_argument("--timestamps needs the interleaved layout (drop --by_product)");
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << "\nUsage: " << argv[0]
+              << " [N] [--threads=T] [--by_product] [--timestamps[=US]] [--binary]\n";
+    return 1;
+  }
 
-  GenPrices("prices.txt", N);
-  GenTrades("trades.txt");
-  GenInquiries("inquiries.txt");
-  GenMarketData("marketdata.txt", N);
+  RegisterBondUniverse();
+  const auto start = std::chrono::steady_clock::now();
+  const std::string md_file = o.binary ? "marketdata.bin" : "marketdata.txt";
+  std::uint64_t bytes = 0;
+  try
+  {
+    bytes += GenPrices("prices.txt", o);
+    bytes += GenTrades("trades.txt", o);
+    bytes += GenInquiries("inquiries.txt", o);
+    bytes += GenMarketData(md_file, o);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "gen_data error: " << e.what() << "\n";
+    return 1;
+  }
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-  std::cout << "Generated prices.txt, trades.txt, inquiries.txt, marketdata.txt\n";
+  std::cout << "Generated prices.txt, trades.txt, inquiries.txt, " << md_file << ": "
+            << bytes << " bytes in " << secs << " s (" << o.threads << " threads)\n";
   return 0;
 }
@@ -1,37 +1,84 @@
 #ifndef EXTERNAL_FILE_TO_SOCKET_PUBLISHERS_HPP
 #define EXTERNAL_FILE_TO_SOCKET_PUBLISHERS_HPP
 
-#include <fstream>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "BondSocketParsers.hpp"
+#include "BondUniverse.hpp"
+#include "FileReplay.hpp"
 #include "TcpLineSocket.hpp"
+#include "TextBuffer.hpp"
 
-inline void PublishFileLinesToSocket(const std::string& filename,
-                                     const std::string& host, int port) {
-  std::ifstream in(filename);
-  if (!in) throw std::runtime_error("Cannot open file: " + filename);
+// Replays filename to host:port (modes in FileReplay.hpp). Firehose checks the
+// sampled lines first, then writes the mapping in chunk_bytes slices as it is; the
+// paced modes collect the lines due so far and write them together.
+template <typename Validate>
+inline ReplayStats PublishFileLinesToSocket(const std::string& filename, const std::string& host, int port,
+                                            Validate&& validate, const ReplayOptions& options = ReplayOptions()) {
+  MappedFile file(filename);
+  const std::string_view data = file.View();
 
   boost::asio::io_context io;
   TcpLineClient client(io);
-  client.Connect(host, port);
 
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty()) continue;
-    client.WriteLine(line);
+  if (options.mode == ReplayMode::kFirehose) {
+    ReplayStats stats = ReplayLines(data, options, validate, [](std::string_view) {}, [] {});
+    client.Connect(host, port);
+    ReplayClock clock;
+    for (std::size_t off = 0; off < data.size(); off += options.chunk_bytes) {
+      client.Write(data.substr(off, options.chunk_bytes));
+      ++stats.writes;
+    }
+    stats.seconds = static_cast<double>(clock.ElapsedNs()) / 1e9;
+    return stats;
   }
+
+  client.Connect(host, port);
+  TextBuffer out(options.chunk_bytes + 1024);
+  std::uint64_t writes = 0;
+  auto flush = [&] {
+    if (out.Size() == 0) return;
+    client.Write(out.View());
+    out.Clear();
+    ++writes;
+  };
+  ReplayStats stats = ReplayLines(
+      data, options, validate,
+      [&](std::string_view line) {
+        out.Append(line).Append('\n');
+        if (out.Size() >= options.chunk_bytes) flush();
+      },
+      flush);
+  stats.writes = writes;
+  return stats;
 }
 
-// Dedicated wrappers (optional clarity)
-inline void PricesFileProcess(const std::string& filename, const std::string& host, int port) {
-  PublishFileLinesToSocket(filename, host, port);
+// Dedicated wrappers: sampled lines are checked with the feed's parser.
+inline ReplayStats PricesFileProcess(const std::string& filename, const std::string& host, int port,
+                                     const ReplayOptions& options = ReplayOptions()) {
+  RegisterBondUniverse();
+  return PublishFileLinesToSocket(filename, host, port, [](std::string_view line) {
+    std::optional<Price<Bond>> p;
+    return TryParsePriceLine(line, p) == ParseStatus::kOk;
+  }, options);
 }
-inline void TradesFileProcess(const std::string& filename, const std::string& host, int port) {
-  PublishFileLinesToSocket(filename, host, port);
+inline ReplayStats TradesFileProcess(const std::string& filename, const std::string& host, int port,
+                                     const ReplayOptions& options = ReplayOptions()) {
+  RegisterBondUniverse();
+  return PublishFileLinesToSocket(filename, host, port, [](std::string_view line) {
+    std::optional<Trade<Bond>> t;
+    return TryParseTradeLine(line, t) == ParseStatus::kOk;
+  }, options);
 }
-inline void InquiriesFileProcess(const std::string& filename, const std::string& host, int port) {
-  PublishFileLinesToSocket(filename, host, port);
+inline ReplayStats InquiriesFileProcess(const std::string& filename, const std::string& host, int port,
+                                        const ReplayOptions& options = ReplayOptions()) {
+  RegisterBondUniverse();
+  return PublishFileLinesToSocket(filename, host, port, [](std::string_view line) {
+    std::optional<Inquiry<Bond>> i;
+    return TryParseInquiryLine(line, i) == ParseStatus::kOk;
+  }, options);
 }
 
-#endif
\ No newline at end of file
+#endif
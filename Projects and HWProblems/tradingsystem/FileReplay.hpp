@@ -0,0 +1,212 @@
+#ifndef FILE_REPLAY_HPP
+#define FILE_REPLAY_HPP
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ShmStringRingBuffer.hpp"  // CpuRelax
+
+// Shared by the file replay tools (prices/trades/inquiries publishers and
+// md_shm_publisher): the input is memory-mapped and walked with memchr, and lines
+// go out in one of three modes.
+//
+//   kFirehose    as fast as possible (the socket publishers write large chunks
+//                straight out of the mapping)
+//   kPaced       a fixed rate in messages/sec
+//   kTimestamped every line starts with "<offset_us>\t"; it is sent that long after
+//                the start (divided by speed) with the prefix removed
+//
+// Waits sleep until shortly before the due time and spin the rest, so pacing holds
+// to a few microseconds. Every validate_every-th line is checked (0 = none).
+enum class ReplayMode : std::uint8_t { kFirehose, kPaced, kTimestamped };
+
+struct ReplayOptions {
+  ReplayMode mode = ReplayMode::kFirehose;
+  double rate = 0;     // kPaced: messages per second
+  double speed = 1.0;  // kTimestamped: 2.0 replays twice as fast
+  std::size_t validate_every = 1000;
+  std::size_t chunk_bytes = 256 * 1024;  // socket writes
+};
+
+struct ReplayStats {
+  std::uint64_t lines = 0;
+  std::uint64_t bytes = 0;
+  std::uint64_t writes = 0;
+  std::uint64_t validated = 0;
+  std::int64_t max_late_ns = 0;  // paced modes: worst send time behind schedule
+  double seconds = 0;
+
+  // "1400 lines, 118591 bytes in 0.0021 s (666666 msgs/s, 3 writes, 2 validated, late max 4 us)"
+  void Print(std::ostream& os) const {
+    os << lines << " lines, " << bytes << " bytes in " << seconds << " s ("
+       << static_cast<long long>(seconds > 0 ? lines / seconds : 0) << " msgs/s, " << writes << " writes, "
+       << validated << " validated";
+    if (max_late_ns) os << ", late max " << max_late_ns / 1000 << " us";
+    os << ")";
+  }
+};
+
+// "--rate=N", "--timestamps", "--timestamps=SPEED", "--validate=N", "--chunk_kb=N".
+// Returns false if arg is not a replay option; throws on a bad value.
+inline bool ParseReplayFlag(std::string_view arg, ReplayOptions& options) {
+  auto value = [&](std::string_view name) -> std::string {
+    return std::string(arg.substr(name.size()));
+  };
+  if (arg.rfind("--rate=", 0) == 0) {
+    options.mode = ReplayMode::kPaced;
+    options.rate = std::stod(value("--rate="));
+    if (options.rate <= 0) throw std::invalid_argument("--rate must be positive");
+  } else if (arg == "--timestamps") {
+    options.mode = ReplayMode::kTimestamped;
+  } else if (arg.rfind("--timestamps=", 0) == 0) {
+    options.mode = ReplayMode::kTimestamped;
+    options.speed = std::stod(value("--timestamps="));
+    if (options.speed <= 0) throw std::invalid_argument("--timestamps speed must be positive");
+  } else if (arg.rfind("--validate=", 0) == 0) {
+    options.validate_every = std::stoul(value("--validate="));
+  } else if (arg.rfind("--chunk_kb=", 0) == 0) {
+    options.chunk_bytes = std::stoul(value("--chunk_kb=")) * 1024;
+    if (options.chunk_bytes == 0) throw std::invalid_argument("--chunk_kb must be positive");
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// The positional arguments of a replay tool, with the replay flags applied to
+// options. Throws on an unknown "--" flag.
+inline std::vector<std::string> SplitReplayArgs(int argc, char** argv, ReplayOptions& options) {
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (ParseReplayFlag(arg, options)) continue;
+    if (arg.rfind("--", 0) == 0) throw std::invalid_argument("Unknown option " + std::string(arg));
+    positional.emplace_back(arg);
+  }
+  return positional;
+}
+
+constexpr const char* kReplayFlagsUsage =
+    "[--rate=MSGS_PER_SEC | --timestamps[=SPEED]] [--validate=EVERY_N (0 = off)] [--chunk_kb=N]";
+
+// Read-only mapping of a whole file.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename) {
+    namespace bip = boost::interprocess;
+    if (!std::filesystem::exists(filename)) throw std::runtime_error("Cannot open file: " + filename);
+    if (std::filesystem::file_size(filename) == 0) return;  // nothing to map
+    file_ = bip::file_mapping(filename.c_str(), bip::read_only);
+    region_ = bip::mapped_region(file_, bip::read_only);
+    region_.advise(bip::mapped_region::advice_sequential);
+  }
+
+  std::string_view View() const {
+    return std::string_view(static_cast<const char*>(region_.get_address()), region_.get_size());
+  }
+
+ private:
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+};
+
+// Splits "<offset_us>\t<payload>". False if the line has no such prefix.
+inline bool SplitReplayTimestamp(std::string_view line, std::int64_t& offset_ns, std::string_view& payload) {
+  const std::size_t tab = line.find('\t');
+  if (tab == std::string_view::npos) return false;
+  std::int64_t us = 0;
+  const auto r = std::from_chars(line.data(), line.data() + tab, us);
+  if (r.ec != std::errc() || r.ptr != line.data() + tab) return false;
+  offset_ns = us * 1000;
+  payload = line.substr(tab + 1);
+  return true;
+}
+
+// Monotonic schedule relative to construction.
+class ReplayClock {
+ public:
+  // Sleeps until this close to the due time, then spins.
+  static constexpr std::int64_t kSpinNs = 200'000;
+
+  ReplayClock() : start_(std::chrono::steady_clock::now()) {}
+
+  std::int64_t ElapsedNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  // Returns once offset_ns has passed: how late the call already was, or 0 if it
+  // had to wait.
+  std::int64_t WaitUntil(std::int64_t offset_ns) {
+    std::int64_t now = ElapsedNs();
+    if (now >= offset_ns) return now - offset_ns;
+    if (offset_ns - now > kSpinNs) std::this_thread::sleep_for(std::chrono::nanoseconds(offset_ns - now - kSpinNs));
+    while (ElapsedNs() < offset_ns) CpuRelax();
+    return 0;
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Calls on_line(payload) for every non-empty line of data when it is due, and
+// flush() before every wait so batched output goes out on time. Lines the
+// validator rejects (on the sampled ones) throw. Returns the stats minus writes.
+template <typename Validate, typename OnLine, typename Flush>
+ReplayStats ReplayLines(std::string_view data, const ReplayOptions& options, Validate&& validate, OnLine&& on_line,
+                        Flush&& flush) {
+  ReplayStats stats;
+  ReplayClock clock;
+  const double ns_per_line = options.mode == ReplayMode::kPaced ? 1e9 / options.rate : 0;
+
+  const char* p = data.data();
+  const char* const end = data.data() + data.size();
+  while (p < end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    if (!nl) nl = end;
+    std::string_view line(p, static_cast<std::size_t>(nl - p));
+    p = nl + 1;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty()) continue;
+
+    std::int64_t due = -1;
+    if (options.mode == ReplayMode::kTimestamped) {
+      std::int64_t offset_ns = 0;
+      if (!SplitReplayTimestamp(line, offset_ns, line))
+        throw std::runtime_error("Line without a replay timestamp: " + std::string(line));
+      due = static_cast<std::int64_t>(static_cast<double>(offset_ns) / options.speed);
+    } else if (options.mode == ReplayMode::kPaced) {
+      due = static_cast<std::int64_t>(static_cast<double>(stats.lines) * ns_per_line);
+    }
+    if (due >= 0) {
+      if (clock.ElapsedNs() < due) flush();
+      const std::int64_t late = clock.WaitUntil(due);
+      if (late > stats.max_late_ns) stats.max_late_ns = late;
+    }
+
+    if (options.validate_every && stats.lines % options.validate_every == 0) {
+      if (!validate(line)) throw std::runtime_error("Bad line: " + std::string(line));
+      ++stats.validated;
+    }
+    on_line(line);
+    ++stats.lines;
+    stats.bytes += line.size() + 1;
+  }
+  flush();
+  stats.seconds = static_cast<double>(clock.ElapsedNs()) / 1e9;
+  return stats;
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <string>
 
+#include "Timestamp.hpp"
 #include "pricingservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
@@ -31,22 +32,16 @@ public:
         last_emit_ = now;
         ++printed_;
 
-        const auto ts_ms = NowEpochMillis();
+        const auto ts_ms = TimestampMs();
 
         out_ << ts_ms << "," << p.GetProduct().GetProductId()
-                << "," << p.GetMid()
-                << "," << p.GetBidOfferSpread()
+                << "," << p.GetMid().ToDouble()
+                << "," << p.GetBidOfferSpread().ToDouble()
                 << "\n";
         out_.flush();
     }
 
 private:
-    static long long NowEpochMillis() 
-    {
-        using namespace std::chrono;
-        return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-    }
-
     std::ofstream out_;
     std::chrono::milliseconds throttle_;
     std::chrono::steady_clock::time_point last_emit_;
@@ -1,35 +1,37 @@
 #ifndef HISTORICAL_FILE_CONNECTORS_HPP
 #define HISTORICAL_FILE_CONNECTORS_HPP
 
-#include <chrono>
 #include <fstream>
 #include <string>
 #include <functional>
 
 #include "BondPriceUtils.hpp"
 #include "BondSocketParsers.hpp"
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
 #include "soa.hpp"
 
-inline long long EpochMillisNow() {
-  using namespace std::chrono;
-  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-}
-
 template <typename V>
 class FilePublishConnector : public Connector<V> {
  public:
+  // serializer: SerializeXxxTo-style function appending one line (no newline).
   explicit FilePublishConnector(const std::string& filename,
-                               std::function<std::string(const V&)> serializer)
+                               std::function<void(const V&, TextBuffer&)> serializer)
       : out_(filename, std::ios::out), serializer_(std::move(serializer)) {}
 
   void Publish(V& data) override {
-    out_ << EpochMillisNow() << "," << serializer_(data) << "\n";
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',');
+    serializer_(data, buf_);
+    buf_.Append('\n');
+    out_.write(buf_.Data(), static_cast<std::streamsize>(buf_.Size()));
     out_.flush();
   }
 
  private:
   std::ofstream out_;
-  std::function<std::string(const V&)> serializer_;
+  std::function<void(const V&, TextBuffer&)> serializer_;
+  TextBuffer buf_;
 };
 
 #endif
\ No newline at end of file
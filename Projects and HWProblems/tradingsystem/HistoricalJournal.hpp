@@ -0,0 +1,437 @@
+#ifndef HISTORICAL_JOURNAL_HPP
+#define HISTORICAL_JOURNAL_HPP
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "BondPriceUtils.hpp"
+#include "HistoricalWriters.hpp"  // kHistoricalBooks
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
+#include "executionservice.hpp"
+#include "inquiryservice.hpp"
+#include "positionservice.hpp"
+#include "products.hpp"
+#include "riskservice.hpp"
+#include "soa.hpp"
+#include "streamingservice.hpp"
+
+// Binary append-only journal for the historical data, the alternative to the CSV
+// writers. A journal file is a JournalHeader followed by fixed-size records of one
+// type, appended into a pre-sized memory-mapped file (grown by doubling when full).
+// Each record is a plain struct with a nanosecond timestamp, so a reader maps the
+// file and indexes records in place; nothing is parsed. record_count in the header
+// is published after each record, so a reader may follow a journal being written.
+//
+// Strings (product ids, order and inquiry ids, bucket names) are fixed char arrays,
+// not NUL-terminated when full; a longer string throws std::length_error.
+
+namespace bip = boost::interprocess;
+
+constexpr char kJournalMagic[8] = {'B', 'H', 'J', 'R', 'N', 'L', '0', '1'};
+constexpr std::uint32_t kJournalVersion = 1;
+constexpr std::size_t kJournalDefaultRecords = 1 << 16;  // initial capacity
+
+enum class JournalRecordType : std::uint32_t {
+  kPosition = 1,
+  kBucketPosition,
+  kRisk,
+  kBucketRisk,
+  kExecution,
+  kStreaming,
+  kInquiry,
+};
+
+struct JournalHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_type;  // JournalRecordType
+  std::uint32_t record_size;
+  std::uint32_t header_size;
+  std::atomic<std::uint64_t> record_count;  // records fully written
+  char schema[224];                         // field list, NUL-terminated
+};
+
+static_assert(sizeof(JournalHeader) == 256, "JournalHeader layout changed");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "journal needs lock-free 64-bit atomics");
+
+struct PositionJournalRecord {
+  std::int64_t ts_ns;
+  char name[16];  // product id, or bucket name
+  std::int64_t books[3];  // kHistoricalBooks order (HistoricalWriters.hpp)
+  std::int64_t aggregate;
+};
+
+struct RiskJournalRecord {
+  std::int64_t ts_ns;
+  char name[16];
+  double pv01;
+  std::int64_t quantity;
+};
+
+struct ExecutionJournalRecord {
+  std::int64_t ts_ns;
+  char product[16];
+  char order_id[32];
+  char parent_order_id[32];
+  std::int64_t price_ticks;
+  std::int64_t visible_quantity;
+  std::int64_t hidden_quantity;
+  std::uint8_t order_type;  // OrderType
+  std::uint8_t pricing_side;  // PricingSide
+  std::uint8_t is_child;
+  std::uint8_t reserved[5];
+};
+
+struct StreamingJournalRecord {
+  std::int64_t ts_ns;
+  char product[16];
+  std::int64_t bid_price_ticks;
+  std::int64_t bid_visible;
+  std::int64_t bid_hidden;
+  std::int64_t offer_price_ticks;
+  std::int64_t offer_visible;
+  std::int64_t offer_hidden;
+};
+
+struct InquiryJournalRecord {
+  std::int64_t ts_ns;
+  char inquiry_id[32];
+  char product[16];
+  std::int64_t price_ticks;
+  std::int64_t quantity;
+  std::uint8_t side;   // Side
+  std::uint8_t state;  // InquiryState
+  std::uint8_t reserved[6];
+};
+
+// Value type -> record layout, type tag and schema text.
+template <typename T>
+struct JournalTraits;
+
+template <>
+struct JournalTraits<Position<Bond>> {
+  using Record = PositionJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kPosition;
+  static constexpr const char* kSchema = "ts_ns:i64,product:c16,TRSY1:i64,TRSY2:i64,TRSY3:i64,AGG:i64";
+};
+
+template <>
+struct JournalTraits<Position<BucketedSector<Bond>>> {
+  using Record = PositionJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kBucketPosition;
+  static constexpr const char* kSchema = "ts_ns:i64,bucket:c16,TRSY1:i64,TRSY2:i64,TRSY3:i64,AGG:i64";
+};
+
+template <>
+struct JournalTraits<PV01<Bond>> {
+  using Record = RiskJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kRisk;
+  static constexpr const char* kSchema = "ts_ns:i64,product:c16,pv01:f64,quantity:i64";
+};
+
+template <>
+struct JournalTraits<PV01<BucketedSector<Bond>>> {
+  using Record = RiskJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kBucketRisk;
+  static constexpr const char* kSchema = "ts_ns:i64,bucket:c16,pv01:f64,quantity:i64";
+};
+
+template <>
+struct JournalTraits<ExecutionOrder<Bond>> {
+  using Record = ExecutionJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kExecution;
+  static constexpr const char* kSchema =
+      "ts_ns:i64,product:c16,order_id:c32,parent_order_id:c32,price_ticks:i64,visible:i64,hidden:i64,"
+      "order_type:u8,side:u8,is_child:u8";
+};
+
+template <>
+struct JournalTraits<PriceStream<Bond>> {
+  using Record = StreamingJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kStreaming;
+  static constexpr const char* kSchema =
+      "ts_ns:i64,product:c16,bid_price_ticks:i64,bid_visible:i64,bid_hidden:i64,offer_price_ticks:i64,"
+      "offer_visible:i64,offer_hidden:i64";
+};
+
+template <>
+struct JournalTraits<Inquiry<Bond>> {
+  using Record = InquiryJournalRecord;
+  static constexpr JournalRecordType kType = JournalRecordType::kInquiry;
+  static constexpr const char* kSchema =
+      "ts_ns:i64,inquiry_id:c32,product:c16,price_ticks:i64,quantity:i64,side:u8,state:u8";
+};
+
+template <std::size_t N>
+inline void PutJournalString(char (&dst)[N], const std::string& s) {
+  if (s.size() > N) throw std::length_error("Journal field too long: " + s);
+  std::memcpy(dst, s.data(), s.size());
+  std::memset(dst + s.size(), 0, N - s.size());
+}
+
+template <std::size_t N>
+inline std::string_view GetJournalString(const char (&src)[N]) {
+  const void* nul = std::memchr(src, '\0', N);
+  return std::string_view(src, nul ? static_cast<const char*>(nul) - src : N);
+}
+
+// ---------- Encoding (value -> record) ----------
+
+template <typename PositionT>
+inline void EncodeJournalPosition(const PositionT& p, const std::string& name, PositionJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.name, name);
+  r.aggregate = 0;
+  for (int i = 0; i < 3; ++i) {
+    r.books[i] = p.GetPosition(kHistoricalBooks[i]);
+    r.aggregate += r.books[i];
+  }
+}
+
+inline void EncodeJournalRecord(const Position<Bond>& p, PositionJournalRecord& r) {
+  EncodeJournalPosition(p, p.GetProduct().GetProductId(), r);
+}
+
+inline void EncodeJournalRecord(const Position<BucketedSector<Bond>>& p, PositionJournalRecord& r) {
+  EncodeJournalPosition(p, p.GetProduct().GetName(), r);
+}
+
+inline void EncodeJournalRecord(const PV01<Bond>& v, RiskJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.name, v.GetProduct().GetProductId());
+  r.pv01 = v.GetPV01();
+  r.quantity = v.GetQuantity();
+}
+
+inline void EncodeJournalRecord(const PV01<BucketedSector<Bond>>& v, RiskJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.name, v.GetProduct().GetName());
+  r.pv01 = v.GetPV01();
+  r.quantity = v.GetQuantity();
+}
+
+inline void EncodeJournalRecord(const ExecutionOrder<Bond>& e, ExecutionJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.product, e.GetProduct().GetProductId());
+  PutJournalString(r.order_id, e.GetOrderId());
+  PutJournalString(r.parent_order_id, e.GetParentOrderId());
+  r.price_ticks = e.GetPrice().Ticks();
+  r.visible_quantity = e.GetVisibleQuantity();
+  r.hidden_quantity = e.GetHiddenQuantity();
+  r.order_type = static_cast<std::uint8_t>(e.GetOrderType());
+  r.pricing_side = static_cast<std::uint8_t>(e.GetSide());
+  r.is_child = e.IsChildOrder() ? 1 : 0;
+  std::memset(r.reserved, 0, sizeof(r.reserved));
+}
+
+inline void EncodeJournalRecord(const PriceStream<Bond>& s, StreamingJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.product, s.GetProduct().GetProductId());
+  r.bid_price_ticks = s.GetBidOrder().GetPrice().Ticks();
+  r.bid_visible = s.GetBidOrder().GetVisibleQuantity();
+  r.bid_hidden = s.GetBidOrder().GetHiddenQuantity();
+  r.offer_price_ticks = s.GetOfferOrder().GetPrice().Ticks();
+  r.offer_visible = s.GetOfferOrder().GetVisibleQuantity();
+  r.offer_hidden = s.GetOfferOrder().GetHiddenQuantity();
+}
+
+inline void EncodeJournalRecord(const Inquiry<Bond>& i, InquiryJournalRecord& r) {
+  r.ts_ns = TimestampNs();
+  PutJournalString(r.inquiry_id, i.GetInquiryId());
+  PutJournalString(r.product, i.GetProduct().GetProductId());
+  r.price_ticks = i.GetPrice().Ticks();
+  r.quantity = i.GetQuantity();
+  r.side = static_cast<std::uint8_t>(i.GetSide());
+  r.state = static_cast<std::uint8_t>(i.GetState());
+  std::memset(r.reserved, 0, sizeof(r.reserved));
+}
+
+// ---------- CSV (record -> the CSV writers' line layout) ----------
+// ts is the record's timestamp in ns, or in ms (as the CSV files have it) with to_ms.
+
+inline void AppendJournalTs(TextBuffer& buf, std::int64_t ts_ns, bool to_ms) {
+  buf.AppendInt(to_ms ? ts_ns / 1000000 : ts_ns);
+}
+
+inline void AppendJournalCsv(TextBuffer& buf, const PositionJournalRecord& r, bool to_ms) {
+  for (int i = 0; i < 3; ++i) {
+    AppendJournalTs(buf, r.ts_ns, to_ms);
+    buf.Append(',').Append(GetJournalString(r.name)).Append(',').Append(kHistoricalBooks[i]).Append(',').AppendInt(r.books[i]);
+    buf.Append('\n');
+  }
+  AppendJournalTs(buf, r.ts_ns, to_ms);
+  buf.Append(',').Append(GetJournalString(r.name)).Append(",AGG,").AppendInt(r.aggregate).Append('\n');
+}
+
+inline void AppendJournalCsv(TextBuffer& buf, const RiskJournalRecord& r, bool to_ms) {
+  AppendJournalTs(buf, r.ts_ns, to_ms);
+  buf.Append(',').Append(GetJournalString(r.name)).Append(',').AppendDouble(r.pv01).Append(',').AppendInt(r.quantity);
+  buf.Append('\n');
+}
+
+inline void AppendJournalCsv(TextBuffer& buf, const ExecutionJournalRecord& r, bool to_ms) {
+  AppendJournalTs(buf, r.ts_ns, to_ms);
+  buf.Append(',').Append(GetJournalString(r.product)).Append(',').Append(GetJournalString(r.order_id));
+  buf.Append(',').AppendInt(r.order_type).Append(',');
+  AppendPriceFractional(buf, PriceTicks(r.price_ticks));
+  buf.Append(',').AppendInt(r.visible_quantity).Append(',').AppendInt(r.hidden_quantity);
+  buf.Append(',').Append(GetJournalString(r.parent_order_id)).Append(',').Append(r.is_child ? '1' : '0');
+  buf.Append('\n');
+}
+
+inline void AppendJournalCsv(TextBuffer& buf, const StreamingJournalRecord& r, bool to_ms) {
+  AppendJournalTs(buf, r.ts_ns, to_ms);
+  buf.Append(',').Append(GetJournalString(r.product)).Append(',');
+  AppendPriceFractional(buf, PriceTicks(r.bid_price_ticks));
+  buf.Append(',').AppendInt(r.bid_visible).Append(',').AppendInt(r.bid_hidden).Append(',');
+  AppendPriceFractional(buf, PriceTicks(r.offer_price_ticks));
+  buf.Append(',').AppendInt(r.offer_visible).Append(',').AppendInt(r.offer_hidden).Append('\n');
+}
+
+inline void AppendJournalCsv(TextBuffer& buf, const InquiryJournalRecord& r, bool to_ms) {
+  AppendJournalTs(buf, r.ts_ns, to_ms);
+  buf.Append(',').Append(GetJournalString(r.inquiry_id)).Append(',').Append(GetJournalString(r.product));
+  buf.Append(',').Append(r.side == BUY ? "BUY" : "SELL").Append(',').AppendInt(r.quantity).Append(',');
+  AppendPriceFractional(buf, PriceTicks(r.price_ticks));
+  buf.Append(',').AppendInt(r.state).Append('\n');
+}
+
+// ---------- Writer ----------
+
+// Appends records of one type to a journal file (created or truncated). Single
+// writer. On destruction the file is cut back to the records written.
+template <typename Record>
+class JournalWriter {
+ public:
+  static_assert(std::is_trivially_copyable_v<Record>, "journal records must be memcpy-able");
+
+  JournalWriter(const std::string& filename, JournalRecordType type, const char* schema,
+                std::size_t initial_records = kJournalDefaultRecords)
+      : filename_(filename) {
+    std::ofstream(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    Map(initial_records < 1 ? 1 : initial_records);
+
+    std::memcpy(header_->magic, kJournalMagic, sizeof(kJournalMagic));
+    header_->version = kJournalVersion;
+    header_->record_type = static_cast<std::uint32_t>(type);
+    header_->record_size = sizeof(Record);
+    header_->header_size = sizeof(JournalHeader);
+    header_->record_count.store(0, std::memory_order_relaxed);
+    std::memset(header_->schema, 0, sizeof(header_->schema));
+    std::strncpy(header_->schema, schema, sizeof(header_->schema) - 1);
+  }
+
+  JournalWriter(const JournalWriter&) = delete;
+  JournalWriter& operator=(const JournalWriter&) = delete;
+
+  ~JournalWriter() {
+    const std::uint64_t n = count_;
+    region_.flush();
+    region_ = bip::mapped_region();
+    std::error_code ec;
+    std::filesystem::resize_file(filename_, sizeof(JournalHeader) + n * sizeof(Record), ec);
+  }
+
+  // The next record slot; fill it, then Commit().
+  Record& Next() {
+    if (count_ == capacity_) Grow();
+    return records_[count_];
+  }
+
+  void Commit() { header_->record_count.store(++count_, std::memory_order_release); }
+
+  std::uint64_t Count() const { return count_; }
+
+ private:
+  void Map(std::size_t records) {
+    std::filesystem::resize_file(filename_, sizeof(JournalHeader) + records * sizeof(Record));
+    bip::file_mapping file(filename_.c_str(), bip::read_write);
+    region_ = bip::mapped_region(file, bip::read_write);
+    header_ = static_cast<JournalHeader*>(region_.get_address());
+    records_ = reinterpret_cast<Record*>(static_cast<char*>(region_.get_address()) + sizeof(JournalHeader));
+    capacity_ = records;
+  }
+
+  void Grow() {
+    region_ = bip::mapped_region();
+    Map(capacity_ * 2);
+  }
+
+  std::string filename_;
+  bip::mapped_region region_;
+  JournalHeader* header_ = nullptr;
+  Record* records_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::uint64_t count_ = 0;
+};
+
+// Connector for BondHistoricalDataServiceBase: one record per Publish.
+template <typename T>
+class JournalConnector final : public Connector<T> {
+ public:
+  using Traits = JournalTraits<T>;
+
+  explicit JournalConnector(const std::string& filename) : journal_(filename, Traits::kType, Traits::kSchema) {}
+
+  void Publish(T& data) override {
+    EncodeJournalRecord(data, journal_.Next());
+    journal_.Commit();
+  }
+
+ private:
+  JournalWriter<typename Traits::Record> journal_;
+};
+
+// ---------- Reader ----------
+
+// Maps a journal read-only. Records are used in place: Get<Record>()[i] for
+// i < Count(). Throws on a file that is not a journal.
+class JournalReader {
+ public:
+  explicit JournalReader(const std::string& filename)
+      : file_(filename.c_str(), bip::read_only), region_(file_, bip::read_only) {
+    if (region_.get_size() < sizeof(JournalHeader)) throw std::runtime_error("Not a journal: " + filename);
+    header_ = static_cast<const JournalHeader*>(region_.get_address());
+    if (std::memcmp(header_->magic, kJournalMagic, sizeof(kJournalMagic)) != 0 || header_->version != kJournalVersion)
+      throw std::runtime_error("Not a journal (bad magic or version): " + filename);
+    if (header_->header_size != sizeof(JournalHeader) || header_->record_size == 0)
+      throw std::runtime_error("Bad journal header: " + filename);
+    mapped_records_ = (region_.get_size() - sizeof(JournalHeader)) / header_->record_size;
+  }
+
+  JournalRecordType Type() const { return static_cast<JournalRecordType>(header_->record_type); }
+  std::size_t RecordSize() const { return header_->record_size; }
+  std::string_view Schema() const { return GetJournalString(header_->schema); }
+
+  // Records committed (and within this mapping).
+  std::uint64_t Count() const {
+    const std::uint64_t n = header_->record_count.load(std::memory_order_acquire);
+    return n < mapped_records_ ? n : mapped_records_;
+  }
+
+  template <typename Record>
+  const Record* Get() const {
+    if (sizeof(Record) != header_->record_size) throw std::runtime_error("Journal record size mismatch");
+    return reinterpret_cast<const Record*>(static_cast<const char*>(region_.get_address()) + sizeof(JournalHeader));
+  }
+
+ private:
+  bip::file_mapping file_;
+  bip::mapped_region region_;
+  const JournalHeader* header_ = nullptr;
+  std::uint64_t mapped_records_ = 0;
+};
+
+#endif
@@ -1,12 +1,14 @@
 #ifndef HISTORICAL_WRITERS_HPP
 #define HISTORICAL_WRITERS_HPP
 
-#include <chrono>
 #include <fstream>
 #include <string>
 #include <vector>
 
+#include "AsyncHistoricalWriter.hpp"
 #include "BondPriceUtils.hpp"
+#include "TextBuffer.hpp"
+#include "Timestamp.hpp"
 #include "products.hpp"
 #include "riskservice.hpp"
 #include "soa.hpp"
@@ -14,37 +16,64 @@
 #include "executionservice.hpp"
 #include "inquiryservice.hpp"
 
-// Timestamp helper
-inline long long NowMs() {
-  using namespace std::chrono;
-  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+// Each writer formats into its own TextBuffer (reused across Publish calls) and
+// hands the finished bytes to its HistoricalFile: written and flushed right away,
+// or, given an AsyncHistoricalWriter, queued for its writer thread.
+class HistoricalFile {
+ public:
+  explicit HistoricalFile(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : async_(async), async_file_(async ? &async->Open(filename) : nullptr) {
+    if (!async_) out_.open(filename, std::ios::out);
+  }
+
+  void Write(const TextBuffer& buf) {
+    if (async_) {
+      async_->Append(*async_file_, buf.View());
+      return;
+    }
+    out_.write(buf.Data(), static_cast<std::streamsize>(buf.Size()));
+    out_.flush();
+  }
+
+ private:
+  AsyncHistoricalWriter* async_;
+  AsyncHistoricalWriter::File* async_file_;
+  std::ofstream out_;
+};
+
+// Books every position writer reports, plus an AGG line.
+inline const std::string kHistoricalBooks[] = {"TRSY1", "TRSY2", "TRSY3"};
+
+// "ts,name,book,qty" for each book, then "ts,name,AGG,sum".
+template <typename PositionT>
+inline void AppendPositionLines(TextBuffer& buf, const std::string& name, const PositionT& p) {
+  const long long ts = TimestampMs();
+  long agg = 0;
+  for (const auto& b : kHistoricalBooks) {
+    const long q = p.GetPosition(b);
+    agg += q;
+    buf.AppendInt(ts).Append(',').Append(name).Append(',').Append(b).Append(',').AppendInt(q).Append('\n');
+  }
+  buf.AppendInt(ts).Append(',').Append(name).Append(",AGG,").AppendInt(agg).Append('\n');
 }
 
 // ---------- Positions writer ----------
 template <typename T>
 class PositionFileConnector final : public Connector<Position<T>> {
  public:
-  explicit PositionFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit PositionFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(Position<T>& p) override {
-    const std::string pid = p.GetProduct().GetProductId();
-
     // Persist each book + aggregate
-    std::vector<std::string> books = {"TRSY1", "TRSY2", "TRSY3"};
-    long agg = 0;
-    for (auto& b : books) {
-      std::string bb = b;
-      long q = p.GetPosition(bb);
-      agg += q;
-      out_ << NowMs() << "," << pid << "," << b << "," << q << "\n";
-    }
-    out_ << NowMs() << "," << pid << "," << "AGG" << "," << agg << "\n";
-    out_.flush();
+    buf_.Clear();
+    AppendPositionLines(buf_, p.GetProduct().GetProductId(), p);
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 
@@ -53,133 +82,135 @@ class PositionFileConnector final : public Connector<Position<T>> {
 template <typename T>
 class BucketPositionFileConnector final : public Connector<Position<BucketedSector<T>>> {
  public:
-  explicit BucketPositionFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit BucketPositionFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(Position<BucketedSector<T>>& p) override {
-    const std::string bucket = p.GetProduct().GetName();
-
     // Persist each book + aggregate (AGG)
-    std::vector<std::string> books = {"TRSY1", "TRSY2", "TRSY3"};
-    long agg = 0;
-    for (auto& b : books) {
-      std::string bb = b;
-      long q = p.GetPosition(bb);
-      agg += q;
-      out_ << NowMs() << "," << bucket << "," << b << "," << q << "\n";
-    }
-    out_ << NowMs() << "," << bucket << "," << "AGG" << "," << agg << "\n";
-    out_.flush();
+    buf_.Clear();
+    AppendPositionLines(buf_, p.GetProduct().GetName(), p);
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 // ---------- Risk writer ----------
 template <typename T>
 class RiskFileConnector final : public Connector<PV01<T>> {
  public:
-  explicit RiskFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit RiskFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(PV01<T>& r) override {
-    out_ << NowMs() << "," << r.GetProduct().GetProductId()
-         << "," << r.GetPV01() << "," << r.GetQuantity() << "\n";
-    out_.flush();
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',').Append(r.GetProduct().GetProductId())
+        .Append(',').AppendDouble(r.GetPV01()).Append(',').AppendInt(r.GetQuantity()).Append('\n');
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 // Bucket sector risk writer (FrontEnd/Belly/LongEnd)
 template <typename T>
 class BucketRiskFileConnector final : public Connector<PV01<BucketedSector<T>>> {
  public:
-  explicit BucketRiskFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit BucketRiskFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(PV01<BucketedSector<T>>& r) override {
-    out_ << NowMs() << "," << r.GetProduct().GetName()
-         << "," << r.GetPV01() << "," << r.GetQuantity() << "\n";
-    out_.flush();
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',').Append(r.GetProduct().GetName())
+        .Append(',').AppendDouble(r.GetPV01()).Append(',').AppendInt(r.GetQuantity()).Append('\n');
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 // ---------- Executions writer ----------
 template <typename T>
 class ExecutionFileConnector final : public Connector<ExecutionOrder<T>> {
  public:
-  explicit ExecutionFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit ExecutionFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(ExecutionOrder<T>& e) override {
-    out_ << NowMs() << "," << e.GetProduct().GetProductId()
-         << "," << e.GetOrderId()
-         << "," << static_cast<int>(e.GetOrderType())
-         << "," << FormatPriceFractional(e.GetPrice())
-         << "," << e.GetVisibleQuantity()
-         << "," << e.GetHiddenQuantity()
-         << "," << e.GetParentOrderId()
-         << "," << (e.IsChildOrder() ? 1 : 0)
-         << "\n";
-    out_.flush();
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',').Append(e.GetProduct().GetProductId())
+        .Append(',').Append(e.GetOrderId())
+        .Append(',').AppendInt(static_cast<int>(e.GetOrderType()))
+        .Append(',');
+    AppendPriceFractional(buf_, e.GetPrice());
+    buf_.Append(',').AppendInt(e.GetVisibleQuantity())
+        .Append(',').AppendInt(e.GetHiddenQuantity())
+        .Append(',').Append(e.GetParentOrderId())
+        .Append(',').Append(e.IsChildOrder() ? '1' : '0')
+        .Append('\n');
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 // ---------- Streaming writer ----------
 template <typename T>
 class StreamingFileConnector final : public Connector<PriceStream<T>> {
  public:
-  explicit StreamingFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit StreamingFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(PriceStream<T>& ps) override {
-    const auto& bid = ps.GetBidOrder();
-    const auto& off = ps.GetOfferOrder();
-
-    out_ << NowMs() << "," << ps.GetProduct().GetProductId()
-         << "," << FormatPriceFractional(bid.GetPrice())
-         << "," << bid.GetVisibleQuantity()
-         << "," << bid.GetHiddenQuantity()
-         << "," << FormatPriceFractional(off.GetPrice())
-         << "," << off.GetVisibleQuantity()
-         << "," << off.GetHiddenQuantity()
-         << "\n";
-    out_.flush();
+    auto append_order = [this](const PriceStreamOrder& o) {
+      buf_.Append(',');
+      AppendPriceFractional(buf_, o.GetPrice());
+      buf_.Append(',').AppendInt(o.GetVisibleQuantity()).Append(',').AppendInt(o.GetHiddenQuantity());
+    };
+
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',').Append(ps.GetProduct().GetProductId());
+    append_order(ps.GetBidOrder());
+    append_order(ps.GetOfferOrder());
+    buf_.Append('\n');
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
 // ---------- Inquiry writer ----------
 template <typename T>
 class InquiryFileConnector final : public Connector<Inquiry<T>> {
  public:
-  explicit InquiryFileConnector(const std::string& filename)
-      : out_(filename, std::ios::out) {}
+  explicit InquiryFileConnector(const std::string& filename, AsyncHistoricalWriter* async = nullptr)
+      : out_(filename, async) {}
 
   void Publish(Inquiry<T>& i) override {
-    out_ << NowMs() << "," << i.GetInquiryId()
-         << "," << i.GetProduct().GetProductId()
-         << "," << (i.GetSide() == BUY ? "BUY" : "SELL")
-         << "," << i.GetQuantity()
-         << "," << FormatPriceFractional(i.GetPrice())
-         << "," << static_cast<int>(i.GetState())
-         << "\n";
-    out_.flush();
+    buf_.Clear();
+    buf_.AppendInt(TimestampMs()).Append(',').Append(i.GetInquiryId())
+        .Append(',').Append(i.GetProduct().GetProductId())
+        .Append(',').Append(i.GetSide() == BUY ? "BUY" : "SELL")
+        .Append(',').AppendInt(i.GetQuantity())
+        .Append(',');
+    AppendPriceFractional(buf_, i.GetPrice());
+    buf_.Append(',').AppendInt(static_cast<int>(i.GetState())).Append('\n');
+    out_.Write(buf_);
   }
 
  private:
-  std::ofstream out_;
+  HistoricalFile out_;
+  TextBuffer buf_;
 };
 
-#endif
\ No newline at end of file
+#endif
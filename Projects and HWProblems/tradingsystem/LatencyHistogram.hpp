@@ -0,0 +1,210 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+#include "Timestamp.hpp"
+
+// Per-stage latency of the inbound paths, measured from ingress: the moment a line
+// is handed to its TCP connector, or a record is taken off the market data ring.
+//
+// The ingress time travels with the message: LatencyScope holds it for the thread
+// while the message is handled (services call each other synchronously), and the
+// sequencer queues carry it across to the sequencer thread. Each service records
+// (now - ingress) into its stage's histogram when it is entered, so a stage shows
+// everything up to that point, queueing included. Off unless LatencyStats::Enable()
+// is called (trading_system --latency); then a record costs a clock read and two
+// atomic adds. Needs a fine clock: under --clock=coarse the numbers are meaningless.
+enum class LatencyStage : std::uint8_t {
+  // tick-to-trade
+  kMdParse,
+  kMarketData,
+  kAlgoExecution,
+  kExecution,
+  kTradeBooking,  // trade_booking, position and risk also see the trades feed
+  kPosition,
+  kRisk,
+  kExecutionOut,  // handed to the execution connector, after the booking chain
+  // price-to-stream
+  kPxParse,
+  kPricing,
+  kAlgoStreaming,
+  kStreaming,
+  kStreamingOut,
+  // other feeds
+  kTrParse,
+  kIqParse,
+  kCount
+};
+
+constexpr std::size_t kLatencyStageCount = static_cast<std::size_t>(LatencyStage::kCount);
+
+inline const char* LatencyStageName(LatencyStage s) {
+  switch (s) {
+    case LatencyStage::kMdParse: return "parse.md";
+    case LatencyStage::kMarketData: return "marketdata";
+    case LatencyStage::kAlgoExecution: return "algo_execution";
+    case LatencyStage::kExecution: return "execution";
+    case LatencyStage::kTradeBooking: return "trade_booking";
+    case LatencyStage::kPosition: return "position";
+    case LatencyStage::kRisk: return "risk";
+    case LatencyStage::kExecutionOut: return "execution.out";
+    case LatencyStage::kPxParse: return "parse.px";
+    case LatencyStage::kPricing: return "pricing";
+    case LatencyStage::kAlgoStreaming: return "algo_streaming";
+    case LatencyStage::kStreaming: return "streaming";
+    case LatencyStage::kStreamingOut: return "streaming.out";
+    case LatencyStage::kTrParse: return "parse.tr";
+    case LatencyStage::kIqParse: return "parse.iq";
+    case LatencyStage::kCount: break;
+  }
+  return "unknown";
+}
+
+// HDR-style log-linear histogram of nanosecond values: exact below 64 ns, then 32
+// buckets per power of two (about 3% error), up to 2^40 ns (about 18 minutes;
+// longer values are clamped). Record() is lock-free and may be called from any
+// thread; readers see a relaxed, approximate view while recording goes on.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 6;
+  static constexpr int kMaxBits = 40;
+  static constexpr std::size_t kHalf = std::size_t{1} << (kSubBucketBits - 1);
+  static constexpr std::size_t kBuckets = static_cast<std::size_t>(kMaxBits - kSubBucketBits + 2) * kHalf;
+
+  void Record(std::int64_t ns) {
+    if (ns < 0) ns = 0;
+    counts_[Index(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    std::int64_t max = max_.load(std::memory_order_relaxed);
+    while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  std::uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  std::int64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Values at the given quantiles (0..1, ascending): the top of the bucket holding
+  // each, capped at the exact max. One pass over a snapshot of the counts.
+  std::vector<std::int64_t> Percentiles(const std::vector<double>& quantiles) const {
+    std::vector<std::uint64_t> counts(kBuckets);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) total += counts[i] = counts_[i].load(std::memory_order_relaxed);
+
+    std::vector<std::int64_t> out(quantiles.size(), 0);
+    if (total == 0) return out;
+    const std::int64_t max = Max();
+    std::uint64_t seen = 0;
+    std::size_t q = 0, i = 0;
+    for (; i < kBuckets && q < quantiles.size(); ++i) {
+      seen += counts[i];
+      while (q < quantiles.size() && static_cast<double>(seen) >= quantiles[q] * static_cast<double>(total)) {
+        out[q++] = std::min(UpperBound(i), max);
+      }
+    }
+    for (; q < quantiles.size(); ++q) out[q] = max;
+    return out;
+  }
+
+  static std::size_t Index(std::int64_t ns) {
+    auto v = static_cast<std::uint64_t>(ns);
+    if (v >= (std::uint64_t{1} << kMaxBits)) v = (std::uint64_t{1} << kMaxBits) - 1;
+    if (v < 2 * kHalf) return static_cast<std::size_t>(v);
+    const int shift = 63 - __builtin_clzll(v) - kSubBucketBits + 1;
+    return static_cast<std::size_t>(shift) * kHalf + static_cast<std::size_t>(v >> shift);
+  }
+
+  // Largest value that lands in bucket i.
+  static std::int64_t UpperBound(std::size_t i) {
+    if (i < 2 * kHalf) return static_cast<std::int64_t>(i);
+    const std::size_t shift = i / kHalf - 1;
+    const std::uint64_t sub = i % kHalf + kHalf;
+    return static_cast<std::int64_t>(((sub + 1) << shift) - 1);
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, kBuckets> counts_{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::int64_t> max_{0};
+};
+
+// The process-wide histograms, one per stage.
+class LatencyStats {
+ public:
+  static void Enable() { EnabledRef().store(true, std::memory_order_relaxed); }
+  static bool Enabled() { return EnabledRef().load(std::memory_order_relaxed); }
+
+  static LatencyHistogram& Of(LatencyStage s) { return Histograms()[static_cast<std::size_t>(s)]; }
+
+  // One line per stage that saw anything, in microseconds:
+  // "[Latency] marketdata      count=1400      p50=1.20      p99=8.40  ..."
+  static void Print(std::ostream& os) {
+    os << "[Latency] from ingress, in us\n";
+    static const std::vector<double> quantiles = {0.5, 0.99, 0.999};
+    for (std::size_t s = 0; s < kLatencyStageCount; ++s) {
+      const LatencyHistogram& h = Histograms()[s];
+      const std::uint64_t n = h.Count();
+      if (n == 0) continue;
+      const auto p = h.Percentiles(quantiles);
+      char line[160];
+      std::snprintf(line, sizeof line, "[Latency] %-15s count=%-9llu p50=%-9.2f p99=%-9.2f p99.9=%-9.2f max=%.2f\n",
+                    LatencyStageName(static_cast<LatencyStage>(s)), static_cast<unsigned long long>(n),
+                    p[0] / 1e3, p[1] / 1e3, p[2] / 1e3, h.Max() / 1e3);
+      os << line;
+    }
+  }
+
+ private:
+  static std::atomic<bool>& EnabledRef() {
+    static std::atomic<bool> enabled{false};
+    return enabled;
+  }
+
+  static std::array<LatencyHistogram, kLatencyStageCount>& Histograms() {
+    static std::array<LatencyHistogram, kLatencyStageCount> histograms;
+    return histograms;
+  }
+};
+
+namespace latency_detail {
+inline thread_local std::int64_t ingress_ns = 0;  // 0: nothing being measured on this thread
+}
+
+// The ingress time of the message this thread is handling, until destroyed (the
+// previous one is restored). 0 measures nothing.
+class LatencyScope {
+ public:
+  explicit LatencyScope(std::int64_t ingress_ns) : saved_(latency_detail::ingress_ns) {
+    latency_detail::ingress_ns = ingress_ns;
+  }
+  ~LatencyScope() { latency_detail::ingress_ns = saved_; }
+
+  LatencyScope(const LatencyScope&) = delete;
+  LatencyScope& operator=(const LatencyScope&) = delete;
+
+  // For messages queued to another thread.
+  static std::int64_t CurrentNs() { return latency_detail::ingress_ns; }
+
+ private:
+  std::int64_t saved_;
+};
+
+// Ingress time for a message entering the process now (0 when measuring is off).
+inline std::int64_t LatencyIngressNs() { return LatencyStats::Enabled() ? TimestampClock::NowNs() : 0; }
+
+// Time since the current message's ingress, into stage's histogram. A thread-local
+// load when nothing is being measured.
+inline void RecordLatency(LatencyStage stage) {
+  const std::int64_t ingress = latency_detail::ingress_ns;
+  if (ingress == 0) return;
+  LatencyStats::Of(stage).Record(TimestampClock::NowNs() - ingress);
+}
+
+#endif
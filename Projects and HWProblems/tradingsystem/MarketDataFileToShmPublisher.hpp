@@ -1,33 +1,117 @@
 #ifndef MARKETDATA_FILE_TO_SHM_PUBLISHER_HPP
 #define MARKETDATA_FILE_TO_SHM_PUBLISHER_HPP
 
-#include <fstream>
+#include <iostream>
 #include <string>
 
 #include "BondMarketDataShmConnectors.hpp"
 #include "BondSocketParsers.hpp"
 #include "BondUniverse.hpp"
+#include "FileReplay.hpp"
 #include <boost/interprocess/shared_memory_object.hpp>
 
 
-inline void MarketDataFileToShmProcess(const std::string& marketdata_file,
-                                       const std::string& shm_name) {
+// Publishes every book in marketdata_file to shm_name.
+//   broadcast=false: SPSC byte ring read by one trading_system
+//   broadcast=true : broadcast ring any number of subscriber processes can attach to
+// ring_bytes sizes the segment; 0 picks the default for the chosen ring.
+// Binary books go out as snapshots plus deltas (see MdShmBookEncoder); snapshot_every
+// = 0 sends every line as a snapshot. Text lines are forwarded as they are, straight
+// from the mapped file, and only every replay.validate_every-th one is parsed (binary
+// encoding parses them all). replay sets firehose, paced or timestamped replay.
+// A marketdata.bin from gen_data --binary is detected by its first record and
+// decoded record by record instead (firehose or paced).
+inline ReplayStats MarketDataFileToShmProcess(const std::string& marketdata_file,
+                                              const std::string& shm_name,
+                                              MdWireFormat format = kMdDefaultWireFormat,
+                                              std::size_t ring_bytes = 0,
+                                              bool broadcast = false,
+                                              std::size_t snapshot_every = kMdDefaultSnapshotEvery,
+                                              ReplayOptions replay = ReplayOptions()) {
   RegisterBondUniverse();
 
-  std::ifstream in(marketdata_file);
-  if (!in) throw std::runtime_error("Cannot open market data file: " + marketdata_file);
+  MappedFile in(marketdata_file);
 
   // Create SHM segment and publish messages
   boost::interprocess::shared_memory_object::remove("BOND_MD_SHM");
-  ShmQueueHandle<kMdShmCapacity, kMdMsgSize> shm(shm_name, /*create=*/true);
-
-  std::string line;
-  while (std::getline(in, line)) {
-    if (line.empty()) continue;
-    // Validate parse once (optional) and push raw string
-    (void)ParseOrderBookLine(line);
-    shm.Push(line);
+
+  MdShmBookEncoder encoder(format, snapshot_every);
+  std::uint64_t lines = 0;
+  std::uint64_t text_bytes = 0;
+  std::uint64_t snapshot_bytes = 0;  // what the same books cost as binary snapshots
+
+  const Bond* bond = nullptr;
+  OrderBook<Bond>::Stack bids, offers;  // reused across lines
+  auto parse = [&](std::string_view line) {
+    const ParseStatus st = TryParseOrderBookLine(line, bond, bids, offers);
+    if (st != ParseStatus::kOk)
+      throw std::runtime_error(std::string("Bad orderbook line (") + ParseStatusName(st) + "): " + std::string(line));
+    return true;
+  };
+  if (format != MdWireFormat::kText) replay.validate_every = 0;  // every line is parsed anyway
+
+  // gen_data --binary input: MdBookWire snapshots back to back, decoded without parsing.
+  const std::string_view data = in.View();
+  const bool binary_input = IsMdBookWire(data.data(), data.size());
+  if (binary_input && replay.mode == ReplayMode::kTimestamped)
+    throw std::invalid_argument("--timestamps needs a text input file");
+
+  auto publish_records = [&](auto& shm) {
+    ReplayStats stats;
+    ReplayClock clock;
+    std::uint32_t seq = 0;
+    for (std::size_t off = 0; off < data.size();) {
+      const std::size_t len = MdBookWireRecordSize(data.data() + off, data.size() - off);
+      if (replay.mode == ReplayMode::kPaced) {
+        const std::int64_t late = clock.WaitUntil(static_cast<std::int64_t>(static_cast<double>(stats.lines) * 1e9 / replay.rate));
+        if (late > stats.max_late_ns) stats.max_late_ns = late;
+      }
+      bond = &DecodeOrderBookWire(data.data() + off, len, bids, offers, seq);
+      encoder.Push(shm, OrderBook<Bond>(*bond, bids, offers));
+      snapshot_bytes += len;
+      ++lines;
+      ++stats.lines;
+      stats.bytes += len;
+      off += len;
+    }
+    stats.seconds = static_cast<double>(clock.ElapsedNs()) / 1e9;
+    return stats;
+  };
+
+  auto publish_all = [&](auto& shm) {
+    if (binary_input) return publish_records(shm);
+    return ReplayLines(in.View(), replay, parse, [&](std::string_view line) {
+      ++lines;
+      if (format == MdWireFormat::kText) {
+        shm.Push(line.data(), line.size());
+        text_bytes += line.size();
+      } else {
+        parse(line);
+        encoder.Push(shm, OrderBook<Bond>(*bond, bids, offers));
+        snapshot_bytes += MdBookWireSize(bids.size() + offers.size());
+      }
+    }, [] {});
+  };
+
+  ReplayStats stats;
+  if (broadcast) {
+    const std::size_t slots = ring_bytes ? ring_bytes / kMdBroadcastSlotBytes : kMdBroadcastSlots;
+    ShmBroadcastWriter shm(shm_name, slots, kMdBroadcastSlotBytes);
+    stats = publish_all(shm);
+  } else {
+    MdShmQueue shm(shm_name, /*create=*/true, ring_bytes ? ring_bytes : kMdShmBytes);
+    stats = publish_all(shm);
+  }
+  stats.writes = stats.lines;
+
+  if (format == MdWireFormat::kText) {
+    std::cout << "[md_shm_publisher] " << lines << " books as text, " << text_bytes << " bytes\n";
+  } else {
+    std::cout << "[md_shm_publisher] " << lines << " books: " << encoder.Snapshots() << " snapshots, "
+              << encoder.Deltas() << " deltas (" << encoder.Unchanged() << " empty); "
+              << encoder.Bytes() << " bytes (" << snapshot_bytes << " as full snapshots)\n";
   }
+  return stats;
 }
 
 #endif
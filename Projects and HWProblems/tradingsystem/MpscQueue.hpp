@@ -0,0 +1,122 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "ShmStringRingBuffer.hpp"  // kCacheLineSize, SpinBackoff
+
+// Bounded lock-free multi-producer/single-consumer queue (in-process).
+//
+// Each cell carries a sequence number that says whose turn it is: a producer may
+// fill cell i when seq == its ticket, the consumer may take it when seq == ticket + 1.
+// Producers claim tickets with a CAS on tail; the single consumer owns head. Values
+// are constructed in the cell and consumed in place (Consume), so T needs no default
+// constructor.
+template <typename T>
+class MpscQueue {
+ public:
+  explicit MpscQueue(std::size_t capacity)
+      : mask_(RoundUpPow2(capacity < 2 ? 2 : capacity) - 1), cells_(new Cell[mask_ + 1]) {
+    for (std::size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  std::size_t Capacity() const { return mask_ + 1; }
+
+  // Producer (any thread). Returns false when full; args are only consumed on success.
+  template <typename... Args>
+  bool TryPush(Args&&... args) {
+    std::uint64_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      const std::uint64_t seq = cell.seq.load(std::memory_order_acquire);
+      const auto dif = static_cast<std::int64_t>(seq - pos);
+      if (dif == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.value.emplace(std::forward<Args>(args)...);
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Producer: waits (spin, then yield) while the queue is full, so a slow consumer
+  // pushes back on the feeds instead of losing messages.
+  template <typename... Args>
+  void Push(Args&&... args) {
+    if (TryPush(std::forward<Args>(args)...)) return;
+    full_waits_.fetch_add(1, std::memory_order_relaxed);
+    SpinBackoff backoff;
+    while (!TryPush(std::forward<Args>(args)...)) backoff.Pause();
+  }
+
+  // Consumer (one thread only): fn(T&) sees the oldest value in place; the cell is
+  // released when fn returns (or throws). Returns false when empty.
+  template <typename Fn>
+  bool Consume(Fn&& fn) {
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    Cell& cell = cells_[head & mask_];
+    if (cell.seq.load(std::memory_order_acquire) != head + 1) return false;
+
+    const std::size_t depth = static_cast<std::size_t>(tail_.load(std::memory_order_relaxed) - head);
+    if (depth > high_water_.load(std::memory_order_relaxed)) high_water_.store(depth, std::memory_order_relaxed);
+
+    struct Release {
+      MpscQueue* q;
+      Cell& cell;
+      std::uint64_t head;
+      ~Release() {
+        cell.value.reset();
+        cell.seq.store(head + q->mask_ + 1, std::memory_order_release);
+        q->head_.store(head + 1, std::memory_order_relaxed);
+      }
+    } release{this, cell, head};
+
+    fn(*cell.value);
+    return true;
+  }
+
+  // Statistics, readable from any thread (relaxed, approximate while running).
+  std::size_t Depth() const {
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    return tail > head ? static_cast<std::size_t>(tail - head) : 0;
+  }
+  std::size_t HighWater() const { return high_water_.load(std::memory_order_relaxed); }
+  std::uint64_t Popped() const { return head_.load(std::memory_order_relaxed); }
+  std::uint64_t FullWaits() const { return full_waits_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Cell {
+    std::atomic<std::uint64_t> seq{0};
+    std::optional<T> value;
+  };
+
+  static std::size_t RoundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> tail_{0};   // producers
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> head_{0};   // consumer
+  std::atomic<std::size_t> high_water_{0};                       // consumer writes
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> full_waits_{0};
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef PARSE_STATUS_HPP
+#define PARSE_STATUS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Result of parsing one inbound line. The line parsers never throw; callers count
+// and log failures per feed instead.
+enum class ParseStatus : std::uint8_t {
+  kOk,
+  kFieldCount,      // wrong number of delimited fields
+  kUnknownProduct,  // product id not in BondProductRepository
+  kBadPrice,
+  kBadQuantity,
+  kBadLevel,        // order book level is not "price:qty"
+  kTooDeep,         // more order book levels than the book holds
+  kCount
+};
+
+constexpr std::size_t kParseStatusCount = static_cast<std::size_t>(ParseStatus::kCount);
+
+inline const char* ParseStatusName(ParseStatus s) {
+  switch (s) {
+    case ParseStatus::kOk: return "ok";
+    case ParseStatus::kFieldCount: return "field_count";
+    case ParseStatus::kUnknownProduct: return "unknown_product";
+    case ParseStatus::kBadPrice: return "bad_price";
+    case ParseStatus::kBadQuantity: return "bad_quantity";
+    case ParseStatus::kBadLevel: return "bad_level";
+    case ParseStatus::kTooDeep: return "too_deep";
+    case ParseStatus::kCount: break;
+  }
+  return "unknown";
+}
+
+// Per-feed parse counters. Written by the feed's reader thread, readable from any
+// thread (relaxed; they are statistics, not synchronisation).
+class FeedParseStats {
+ public:
+  void Record(ParseStatus s) {
+    by_status_[static_cast<std::size_t>(s)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t Count(ParseStatus s) const {
+    return by_status_[static_cast<std::size_t>(s)].load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t Errors() const {
+    std::uint64_t n = 0;
+    for (std::size_t i = 1; i < kParseStatusCount; ++i) n += by_status_[i].load(std::memory_order_relaxed);
+    return n;
+  }
+
+  // "ok=123 errors=2 (bad_price=1 field_count=1)"
+  void Print(std::ostream& os) const {
+    os << "ok=" << Count(ParseStatus::kOk) << " errors=" << Errors();
+    if (Errors() == 0) return;
+    os << " (";
+    bool first = true;
+    for (std::size_t i = 1; i < kParseStatusCount; ++i) {
+      const std::uint64_t n = by_status_[i].load(std::memory_order_relaxed);
+      if (!n) continue;
+      if (!first) os << ' ';
+      os << ParseStatusName(static_cast<ParseStatus>(i)) << '=' << n;
+      first = false;
+    }
+    os << ')';
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, kParseStatusCount> by_status_{};
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef PRICE_TICKS_HPP
+#define PRICE_TICKS_HPP
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Fixed-point price: a signed count of 1/256ths of a point.
+ * US Treasury prices and spreads in this system always sit on the 1/256 grid, so
+ * PriceTicks compares and adds exactly. Convert to double only for analytics output.
+ */
+class PriceTicks
+{
+public:
+  static constexpr std::int64_t kTicksPerPoint = 256;
+
+  constexpr PriceTicks() = default;
+  constexpr explicit PriceTicks(std::int64_t ticks) : ticks_(ticks) {}
+
+  // Whole points, e.g. FromPoints(100) == 100-000
+  static constexpr PriceTicks FromPoints(std::int64_t points) { return PriceTicks(points * kTicksPerPoint); }
+
+  // Nearest tick to a decimal price
+  static PriceTicks FromDouble(double px)
+  {
+    return PriceTicks(static_cast<std::int64_t>(std::llround(px * static_cast<double>(kTicksPerPoint))));
+  }
+
+  constexpr std::int64_t Ticks() const { return ticks_; }
+
+  double ToDouble() const { return static_cast<double>(ticks_) / static_cast<double>(kTicksPerPoint); }
+
+  constexpr PriceTicks operator+(PriceTicks o) const { return PriceTicks(ticks_ + o.ticks_); }
+  constexpr PriceTicks operator-(PriceTicks o) const { return PriceTicks(ticks_ - o.ticks_); }
+  constexpr PriceTicks operator-() const { return PriceTicks(-ticks_); }
+  constexpr PriceTicks operator*(std::int64_t n) const { return PriceTicks(ticks_ * n); }
+
+  PriceTicks& operator+=(PriceTicks o) { ticks_ += o.ticks_; return *this; }
+  PriceTicks& operator-=(PriceTicks o) { ticks_ -= o.ticks_; return *this; }
+
+  constexpr bool operator==(PriceTicks o) const { return ticks_ == o.ticks_; }
+  constexpr bool operator!=(PriceTicks o) const { return ticks_ != o.ticks_; }
+  constexpr bool operator<(PriceTicks o) const { return ticks_ < o.ticks_; }
+  constexpr bool operator<=(PriceTicks o) const { return ticks_ <= o.ticks_; }
+  constexpr bool operator>(PriceTicks o) const { return ticks_ > o.ticks_; }
+  constexpr bool operator>=(PriceTicks o) const { return ticks_ >= o.ticks_; }
+
+private:
+  std::int64_t ticks_ = 0;
+};
+
+static_assert(sizeof(PriceTicks) == sizeof(std::int64_t), "PriceTicks must stay a bare int64");
+
+#endif
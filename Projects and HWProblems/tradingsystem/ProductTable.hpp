@@ -0,0 +1,67 @@
+#ifndef PRODUCT_TABLE_HPP
+#define PRODUCT_TABLE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BondProductRepository.hpp"
+
+// Per-product service storage: a flat array indexed by the BondProductRepository
+// dense index, so the hot path addresses a product in O(1) with no string work.
+// Product-id strings are only looked up at the API edge (Service::GetData(key)).
+//
+// Slots are std::optional<V> so value types without a default constructor (they all
+// take their product at construction) can be stored and replaced in place.
+template <typename V>
+class ProductTable {
+ public:
+  ProductTable() : slots_(BondProductRepository::Instance().Size()) {}
+
+  std::size_t Capacity() const { return slots_.size(); }
+
+  bool Has(std::size_t index) const { return index < slots_.size() && slots_[index].has_value(); }
+
+  V* Find(std::size_t index) { return Has(index) ? &*slots_[index] : nullptr; }
+  const V* Find(std::size_t index) const { return Has(index) ? &*slots_[index] : nullptr; }
+
+  // Throws std::out_of_range if the product has no value yet (like std::map::at).
+  V& At(std::size_t index) {
+    if (!Has(index)) throw std::out_of_range("ProductTable: no value for product index " + std::to_string(index));
+    return *slots_[index];
+  }
+
+  V& At(const std::string& product_id) { return At(BondProductRepository::Instance().IndexOf(product_id)); }
+
+  // Construct (or replace) the value for a product; returns the stored value.
+  template <typename... Args>
+  V& Emplace(std::size_t index, Args&&... args) {
+    if (index >= slots_.size()) slots_.resize(index + 1);
+    return slots_[index].emplace(std::forward<Args>(args)...);
+  }
+
+  // Existing value, or one built from args if the product has none yet.
+  template <typename... Args>
+  V& FindOrEmplace(std::size_t index, Args&&... args) {
+    if (V* v = Find(index)) return *v;
+    return Emplace(index, std::forward<Args>(args)...);
+  }
+
+  // fn(index, value) for every product that has a value, in index order.
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    for (std::size_t i = 0; i < slots_.size(); ++i)
+      if (slots_[i]) fn(i, *slots_[i]);
+  }
+
+ private:
+  std::vector<std::optional<V>> slots_;
+};
+
+// Dense index of the product a service value refers to.
+inline std::size_t ProductIndexOf(const Bond& bond) { return BondProductRepository::Instance().IndexOf(bond); }
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef SHM_BROADCAST_RING_HPP
+#define SHM_BROADCAST_RING_HPP
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ShmStringRingBuffer.hpp"  // bip, kCacheLineSize, SpinBackoff
+
+// One-writer / many-readers broadcast ring in shared memory.
+//
+// The writer never waits for readers: message n goes into slot n % slot_count and
+// overwrites whatever was there. Each slot carries a sequence stamp (seqlock style):
+// 2n+1 while message n is being written, 2n+2 once it is complete. A reader keeps its
+// own cursor, copies a slot out and re-checks the stamp; if the stamp is not the one
+// it expects, the writer has lapped it and the reader skips ahead instead of blocking
+// the writer. Readers can attach and detach at any time.
+
+constexpr std::uint64_t kShmBroadcastMagic = 0x5453414344524242ull;  // "BBRDCAST"
+
+struct ShmBroadcastHeader {
+  std::uint64_t magic = kShmBroadcastMagic;
+  std::uint64_t slot_count = 0;  // power of two
+  std::uint64_t slot_bytes = 0;  // max payload per slot
+  std::uint64_t slot_stride = 0;  // bytes between slots
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> write_seq{0};  // messages published so far
+};
+
+struct ShmBroadcastSlot {
+  std::atomic<std::uint64_t> seq{0};
+  std::uint32_t len = 0;
+  std::uint32_t reserved = 0;
+  // payload follows
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "broadcast ring needs lock-free 64-bit atomics to live in shared memory");
+
+namespace shm_broadcast_detail {
+
+inline std::uint64_t RoundUp(std::uint64_t v, std::uint64_t align) { return (v + align - 1) / align * align; }
+
+inline std::uint64_t RoundUpPow2(std::uint64_t v) {
+  std::uint64_t p = 1;
+  while (p < v) p <<= 1;
+  return p;
+}
+
+// Maps an existing or new broadcast segment.
+class Mapping {
+ public:
+  Mapping(const std::string& name, bool create, std::uint64_t slot_count, std::uint64_t slot_bytes) {
+    if (create) {
+      slot_count = RoundUpPow2(slot_count ? slot_count : 1);
+      const std::uint64_t stride = RoundUp(sizeof(ShmBroadcastSlot) + slot_bytes, kCacheLineSize);
+      const std::uint64_t header = RoundUp(sizeof(ShmBroadcastHeader), kCacheLineSize);
+
+      bip::shared_memory_object::remove(name.c_str());
+      shm_ = bip::shared_memory_object(bip::create_only, name.c_str(), bip::read_write);
+      shm_.truncate(static_cast<bip::offset_t>(header + slot_count * stride));
+      region_ = bip::mapped_region(shm_, bip::read_write);
+
+      hdr_ = new (region_.get_address()) ShmBroadcastHeader();
+      hdr_->slot_count = slot_count;
+      hdr_->slot_bytes = slot_bytes;
+      hdr_->slot_stride = stride;
+      for (std::uint64_t i = 0; i < slot_count; ++i) new (SlotAddr(i)) ShmBroadcastSlot();
+    } else {
+      shm_ = bip::shared_memory_object(bip::open_only, name.c_str(), bip::read_write);
+      region_ = bip::mapped_region(shm_, bip::read_write);
+      if (region_.get_size() < sizeof(ShmBroadcastHeader))
+        throw std::runtime_error("SHM broadcast ring too small: " + name);
+
+      hdr_ = static_cast<ShmBroadcastHeader*>(region_.get_address());
+      if (hdr_->magic != kShmBroadcastMagic) throw std::runtime_error("Not a SHM broadcast ring: " + name);
+      const std::uint64_t header = RoundUp(sizeof(ShmBroadcastHeader), kCacheLineSize);
+      if (region_.get_size() < header + hdr_->slot_count * hdr_->slot_stride)
+        throw std::runtime_error("SHM broadcast ring truncated: " + name);
+    }
+    mask_ = hdr_->slot_count - 1;
+  }
+
+  ShmBroadcastHeader& Header() const { return *hdr_; }
+
+  ShmBroadcastSlot& Slot(std::uint64_t n) const { return *static_cast<ShmBroadcastSlot*>(SlotAddr(n & mask_)); }
+
+  static char* Payload(ShmBroadcastSlot& s) { return reinterpret_cast<char*>(&s) + sizeof(ShmBroadcastSlot); }
+
+ private:
+  void* SlotAddr(std::uint64_t i) const {
+    const std::uint64_t header = RoundUp(sizeof(ShmBroadcastHeader), kCacheLineSize);
+    return static_cast<char*>(region_.get_address()) + header + i * hdr_->slot_stride;
+  }
+
+  bip::shared_memory_object shm_;
+  bip::mapped_region region_;
+  ShmBroadcastHeader* hdr_ = nullptr;
+  std::uint64_t mask_ = 0;
+};
+
+}  // namespace shm_broadcast_detail
+
+// Writer side. Creates (and owns the layout of) the segment.
+class ShmBroadcastWriter {
+ public:
+  static void Remove(const std::string& name) {
+    bip::shared_memory_object::remove(name.c_str());
+  }
+
+  ShmBroadcastWriter(const std::string& name, std::size_t slot_count, std::size_t slot_bytes)
+      : map_(name, /*create=*/true, slot_count, slot_bytes),
+        next_(map_.Header().write_seq.load(std::memory_order_relaxed)) {}
+
+  std::size_t SlotCount() const { return static_cast<std::size_t>(map_.Header().slot_count); }
+  std::size_t SlotBytes() const { return static_cast<std::size_t>(map_.Header().slot_bytes); }
+
+  void Push(const std::string& msg) { Push(msg.data(), msg.size()); }
+
+  // Never blocks; overwrites the oldest message.
+  void Push(const char* msg, std::size_t len) {
+    if (len > SlotBytes()) throw std::runtime_error("SHM msg too large");
+
+    ShmBroadcastSlot& slot = map_.Slot(next_);
+    slot.seq.store(2 * next_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.len = static_cast<std::uint32_t>(len);
+    std::memcpy(shm_broadcast_detail::Mapping::Payload(slot), msg, len);
+
+    slot.seq.store(2 * next_ + 2, std::memory_order_release);
+    map_.Header().write_seq.store(++next_, std::memory_order_release);
+  }
+
+ private:
+  shm_broadcast_detail::Mapping map_;
+  std::uint64_t next_;
+};
+
+// Reader side. Any number of readers may attach; each keeps its own cursor.
+class ShmBroadcastReader {
+ public:
+  enum class Start { kLatest, kOldest };
+
+  explicit ShmBroadcastReader(const std::string& name, Start start = Start::kLatest)
+      : map_(name, /*create=*/false, 0, 0),
+        scratch_(static_cast<std::size_t>(map_.Header().slot_bytes)) {
+    const std::uint64_t written = map_.Header().write_seq.load(std::memory_order_acquire);
+    cursor_ = (start == Start::kLatest) ? written : OldestKept(written);
+  }
+
+  // Messages this reader lost because the writer lapped it.
+  std::uint64_t Overruns() const { return overruns_; }
+
+  // Blocks for the next message and calls fn(data, len) on a validated private copy,
+  // so the view stays valid for the whole call even if the writer moves on.
+  // On overrun the skipped messages are added to Overruns() and reading resumes half a
+  // ring behind the writer.
+  template <typename Fn>
+  void Consume(Fn&& fn) {
+    SpinBackoff backoff;
+    while (!TryConsume(fn)) backoff.Pause();
+  }
+
+  // As Consume, but returns false at once if there is nothing new to read.
+  template <typename Fn>
+  bool TryConsume(Fn&& fn) {
+    ShmBroadcastHeader& hdr = map_.Header();
+
+    for (;;) {
+      const std::uint64_t written = hdr.write_seq.load(std::memory_order_acquire);
+      if (cursor_ == written) return false;
+
+      ShmBroadcastSlot& slot = map_.Slot(cursor_);
+      const std::uint64_t expected = 2 * cursor_ + 2;
+
+      const std::uint64_t s1 = slot.seq.load(std::memory_order_acquire);
+      if (s1 == expected) {
+        const std::uint32_t len = slot.len;
+        if (len <= scratch_.size()) {
+          std::memcpy(scratch_.data(), shm_broadcast_detail::Mapping::Payload(slot), len);
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (slot.seq.load(std::memory_order_relaxed) == expected) {
+            ++cursor_;
+            fn(static_cast<const char*>(scratch_.data()), static_cast<std::size_t>(len));
+            return true;
+          }
+        }
+      }
+
+      // The slot already holds a newer message: skip what we lost.
+      const std::uint64_t resume = OldestAvailable(hdr.write_seq.load(std::memory_order_acquire));
+      overruns_ += resume - cursor_;
+      cursor_ = resume;
+    }
+  }
+
+ private:
+  // Oldest message worth starting from: half a ring back from the writer, so a
+  // resync is not immediately overrun again by a fast writer.
+  std::uint64_t OldestKept(std::uint64_t written) const {
+    const std::uint64_t keep = map_.Header().slot_count / 2;
+    return (written > keep) ? written - keep : 0;
+  }
+
+  // Where to resume after the message at cursor_ turned out to be unreadable.
+  std::uint64_t OldestAvailable(std::uint64_t written) const {
+    const std::uint64_t oldest = OldestKept(written);
+    return (oldest > cursor_) ? oldest : cursor_ + 1;
+  }
+
+  shm_broadcast_detail::Mapping map_;
+  std::vector<char> scratch_;
+  std::uint64_t cursor_ = 0;
+  std::uint64_t overruns_ = 0;
+};
+
+#endif
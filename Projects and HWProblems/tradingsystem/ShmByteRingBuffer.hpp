@@ -0,0 +1,202 @@
+#ifndef SHM_BYTE_RING_BUFFER_HPP
+#define SHM_BYTE_RING_BUFFER_HPP
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "ShmStringRingBuffer.hpp"  // bip, kCacheLineSize, SpinBackoff
+
+// Variable-length single-producer/single-consumer byte ring in shared memory.
+//
+// Segment layout: ShmByteRingHeader followed by `capacity` data bytes. Each message
+// is stored as a record [uint32 len][payload] padded to 8 bytes. When a record does
+// not fit before the end of the data area, the producer writes a wrap marker in
+// place of a length and continues at offset 0, so every payload is contiguous and
+// can be read in place.
+//
+// head/tail are free-running byte counters (offset = counter & (capacity - 1)).
+
+constexpr std::uint64_t kShmByteRingMagic = 0x474E4952455442ull;  // "BTERING"
+constexpr std::uint32_t kShmByteRingWrapMarker = 0xFFFFFFFFu;
+constexpr std::size_t kShmByteRingAlign = 8;
+
+struct ShmByteRingHeader {
+  std::uint64_t magic = kShmByteRingMagic;
+  std::uint64_t capacity = 0;  // data bytes, power of two; fixed at creation
+
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> head{0};  // consumer writes
+  alignas(kCacheLineSize) std::atomic<std::uint64_t> tail{0};  // producer writes
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "byte ring needs lock-free 64-bit atomics to live in shared memory");
+static_assert(sizeof(ShmByteRingHeader) % kShmByteRingAlign == 0, "data area must stay 8-byte aligned");
+
+class ShmByteRingHandle {
+ public:
+  static constexpr std::size_t kDefaultCapacity = std::size_t{1} << 20;
+
+  static void Remove(const std::string& name) {
+    bip::shared_memory_object::remove(name.c_str());
+  }
+
+  // create=true => create with `capacity` data bytes (rounded up to a power of two);
+  // create=false => open existing, capacity is read from the segment header.
+  ShmByteRingHandle(const std::string& name, bool create, std::size_t capacity = kDefaultCapacity)
+      : name_(name) {
+    if (create) {
+      capacity = RoundUpPow2(capacity < 2 * kShmByteRingAlign ? 2 * kShmByteRingAlign : capacity);
+
+      bip::shared_memory_object::remove(name.c_str());
+      shm_ = bip::shared_memory_object(bip::create_only, name.c_str(), bip::read_write);
+      shm_.truncate(static_cast<bip::offset_t>(sizeof(ShmByteRingHeader) + capacity));
+      region_ = bip::mapped_region(shm_, bip::read_write);
+
+      hdr_ = new (region_.get_address()) ShmByteRingHeader();
+      hdr_->capacity = capacity;
+    } else {
+      shm_ = bip::shared_memory_object(bip::open_only, name.c_str(), bip::read_write);
+      region_ = bip::mapped_region(shm_, bip::read_write);
+      if (region_.get_size() < sizeof(ShmByteRingHeader))
+        throw std::runtime_error("SHM byte ring too small: " + name);
+
+      hdr_ = static_cast<ShmByteRingHeader*>(region_.get_address());
+      if (hdr_->magic != kShmByteRingMagic) throw std::runtime_error("Not a SHM byte ring: " + name);
+      if (region_.get_size() < sizeof(ShmByteRingHeader) + hdr_->capacity)
+        throw std::runtime_error("SHM byte ring truncated: " + name);
+    }
+
+    data_ = static_cast<char*>(region_.get_address()) + sizeof(ShmByteRingHeader);
+    mask_ = hdr_->capacity - 1;
+    cached_head_ = hdr_->head.load(std::memory_order_acquire);
+    cached_tail_ = hdr_->tail.load(std::memory_order_acquire);
+  }
+
+  std::size_t Capacity() const { return static_cast<std::size_t>(hdr_->capacity); }
+
+  // Largest payload Push accepts. Half the ring guarantees a record plus its wrap
+  // padding always fits once the consumer catches up.
+  std::size_t MaxMessageSize() const { return Capacity() / 2 - sizeof(std::uint32_t); }
+
+  void Push(const std::string& msg) { Push(msg.data(), msg.size()); }
+
+  void Push(const char* msg, std::size_t len) {
+    if (len > MaxMessageSize()) throw std::runtime_error("SHM msg too large");
+
+    const std::uint64_t rec = RecordSize(len);
+    std::uint64_t tail = hdr_->tail.load(std::memory_order_relaxed);
+    const std::uint64_t room_to_end = hdr_->capacity - (tail & mask_);
+    const std::uint64_t pad = (rec > room_to_end) ? room_to_end : 0;
+
+    WaitForSpace(tail, pad + rec);
+
+    if (pad) {
+      StoreLen(tail, kShmByteRingWrapMarker);
+      tail += pad;
+    }
+
+    char* p = data_ + (tail & mask_);
+    const std::uint32_t len32 = static_cast<std::uint32_t>(len);
+    std::memcpy(p, &len32, sizeof(len32));
+    std::memcpy(p + sizeof(len32), msg, len);
+
+    hdr_->tail.store(tail + rec, std::memory_order_release);
+  }
+
+  std::string Pop() {
+    std::string msg;
+    Consume([&](const char* data, std::size_t len) { msg.assign(data, len); });
+    return msg;
+  }
+
+  // Zero-copy pop, same contract as ShmQueueHandle::Consume: fn(data, len) sees the
+  // payload in place and the bytes are released when fn returns (or throws).
+  template <typename Fn>
+  void Consume(Fn&& fn) {
+    WaitForData(hdr_->head.load(std::memory_order_relaxed));
+    TryConsume(std::forward<Fn>(fn));
+  }
+
+  // As Consume, but returns false at once if nothing has been published.
+  template <typename Fn>
+  bool TryConsume(Fn&& fn) {
+    std::uint64_t head = hdr_->head.load(std::memory_order_relaxed);
+    if (cached_tail_ == head && (cached_tail_ = hdr_->tail.load(std::memory_order_acquire)) == head) return false;
+
+    std::uint32_t len = LoadLen(head);
+    if (len == kShmByteRingWrapMarker) {
+      head += hdr_->capacity - (head & mask_);
+      WaitForData(head);
+      len = LoadLen(head);
+    }
+
+    struct Release {
+      ShmByteRingHeader* hdr;
+      std::uint64_t next;
+      ~Release() { hdr->head.store(next, std::memory_order_release); }
+    } release{hdr_, head + RecordSize(len)};
+
+    fn(static_cast<const char*>(data_ + (head & mask_) + sizeof(std::uint32_t)), static_cast<std::size_t>(len));
+    return true;
+  }
+
+ private:
+  static std::uint64_t RecordSize(std::size_t len) {
+    const std::uint64_t raw = sizeof(std::uint32_t) + len;
+    return (raw + kShmByteRingAlign - 1) & ~static_cast<std::uint64_t>(kShmByteRingAlign - 1);
+  }
+
+  static std::size_t RoundUpPow2(std::size_t v) {
+    std::size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+  }
+
+  void StoreLen(std::uint64_t pos, std::uint32_t len) {
+    std::memcpy(data_ + (pos & mask_), &len, sizeof(len));
+  }
+
+  std::uint32_t LoadLen(std::uint64_t pos) const {
+    std::uint32_t len = 0;
+    std::memcpy(&len, data_ + (pos & mask_), sizeof(len));
+    return len;
+  }
+
+  // Producer: wait until `need` bytes past tail are free.
+  void WaitForSpace(std::uint64_t tail, std::uint64_t need) {
+    if (tail + need - cached_head_ <= hdr_->capacity) return;
+    SpinBackoff backoff;
+    while (tail + need - (cached_head_ = hdr_->head.load(std::memory_order_acquire)) > hdr_->capacity) {
+      backoff.Pause();
+    }
+  }
+
+  // Consumer: wait until something has been published at head.
+  void WaitForData(std::uint64_t head) {
+    if (cached_tail_ != head) return;
+    SpinBackoff backoff;
+    while ((cached_tail_ = hdr_->tail.load(std::memory_order_acquire)) == head) {
+      backoff.Pause();
+    }
+  }
+
+  std::string name_;
+  bip::shared_memory_object shm_;
+  bip::mapped_region region_;
+  ShmByteRingHeader* hdr_ = nullptr;
+  char* data_ = nullptr;
+  std::uint64_t mask_ = 0;
+
+  // Process-local copies of the other side's counter.
+  std::uint64_t cached_head_ = 0;
+  std::uint64_t cached_tail_ = 0;
+};
+
+#endif
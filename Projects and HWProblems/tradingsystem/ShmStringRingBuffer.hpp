@@ -5,32 +5,102 @@
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/sync/interprocess_condition.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 
+#include <atomic>
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace bip = boost::interprocess;
 
+// Ring flavours that can sit behind ShmQueueHandle.
+//   kMutex: interprocess mutex + condition variables (any number of producers/consumers)
+//   kSpsc : lock-free, exactly one producer process and one consumer process
+enum class ShmRingMode { kMutex, kSpsc };
+
+constexpr std::size_t kCacheLineSize = 64;
+
+// Busy-wait hint for spin loops.
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Spin briefly, then start yielding so a waiting side does not starve the
+// other one when both share a core.
+class SpinBackoff {
+ public:
+  void Pause() {
+    if (spins_ < kSpinLimit) {
+      ++spins_;
+      CpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  static constexpr int kSpinLimit = 256;
+  int spins_ = 0;
+};
+
+// Mutex ring for any number of consumers. A consumer claims a slot (next) under the
+// lock and reads it unlocked; the slot only goes back to the producers (head) once
+// it and every older slot have been released, since consumers can finish out of
+// order.
 template <std::size_t Capacity, std::size_t MsgSize>
 struct ShmStringRingBuffer {
   bip::interprocess_mutex mutex;
   bip::interprocess_condition not_empty;
   bip::interprocess_condition not_full;
 
-  std::size_t head = 0;
-  std::size_t tail = 0;
-  std::size_t count = 0;
+  std::size_t head = 0;     // oldest slot not yet released
+  std::size_t next = 0;     // next slot to claim
+  std::size_t tail = 0;     // next slot to write
+  std::size_t count = 0;    // written and not yet released (claimed or not)
+  std::size_t pending = 0;  // written and not yet claimed
 
+  bool released[Capacity] = {};  // released ahead of head
   std::size_t len[Capacity];
   char data[Capacity][MsgSize];
 };
 
-// Wrapper that maps/owns shared memory
+// Single-producer/single-consumer ring. head and tail are free-running counters
+// (slot = counter % Capacity) kept on separate cache lines so the producer and
+// consumer never write to the same line. The producer publishes a slot with a
+// release store of tail; the consumer frees it with a release store of head.
 template <std::size_t Capacity, std::size_t MsgSize>
+struct ShmSpscRingBuffer {
+  static_assert(std::atomic<std::size_t>::is_always_lock_free,
+                "SPSC ring needs lock-free size_t atomics to live in shared memory");
+
+  alignas(kCacheLineSize) std::atomic<std::size_t> head{0};  // next slot to read (consumer writes)
+  alignas(kCacheLineSize) std::atomic<std::size_t> tail{0};  // next slot to write (producer writes)
+
+  alignas(kCacheLineSize) std::size_t len[Capacity];
+  char data[Capacity][MsgSize];
+};
+
+// Wrapper that maps/owns shared memory
+template <std::size_t Capacity, std::size_t MsgSize, ShmRingMode Mode = ShmRingMode::kMutex>
 class ShmQueueHandle {
  public:
-  using Queue = ShmStringRingBuffer<Capacity, MsgSize>;
+  using Queue = std::conditional_t<Mode == ShmRingMode::kSpsc,
+                                   ShmSpscRingBuffer<Capacity, MsgSize>,
+                                   ShmStringRingBuffer<Capacity, MsgSize>>;
+
+  static constexpr ShmRingMode kMode = Mode;
 
   static void Remove(const std::string& name) {
     bip::shared_memory_object::remove(name.c_str());
@@ -52,44 +122,146 @@ class ShmQueueHandle {
       region_ = bip::mapped_region(shm_, bip::read_write);
       queue_ = static_cast<Queue*>(region_.get_address());
     }
+
+    if constexpr (Mode == ShmRingMode::kSpsc) {
+      cached_head_ = queue_->head.load(std::memory_order_acquire);
+      cached_tail_ = queue_->tail.load(std::memory_order_acquire);
+    }
   }
 
   Queue& Get() { return *queue_; }
 
-  void Push(const std::string& msg) {
-    if (msg.size() >= MsgSize) throw std::runtime_error("SHM msg too large");
+  void Push(const std::string& msg) { Push(msg.data(), msg.size()); }
+
+  // Raw bytes (e.g. a binary record); the slot still gets a trailing '\0'.
+  void Push(const char* msg, std::size_t len) {
+    if (len >= MsgSize) throw std::runtime_error("SHM msg too large");
 
+    if constexpr (Mode == ShmRingMode::kSpsc) {
+      PushSpsc(msg, len);
+    } else {
+      PushLocked(msg, len);
+    }
+  }
+
+  std::string Pop() {
+    std::string msg;
+    Consume([&](const char* data, std::size_t len) { msg.assign(data, len); });
+    return msg;
+  }
+
+  // Zero-copy pop: blocks for the next message and calls fn(const char* data, std::size_t len)
+  // with a read-only view of the slot inside the mapped region. The slot is handed back to
+  // the producer only after fn returns (or throws), so the view must not escape fn.
+  template <typename Fn>
+  void Consume(Fn&& fn) {
+    if constexpr (Mode == ShmRingMode::kSpsc) {
+      ConsumeSpsc(std::forward<Fn>(fn));
+    } else {
+      ConsumeLocked(std::forward<Fn>(fn));
+    }
+  }
+
+ private:
+  // Runs a callable on scope exit; used to release a slot even if the consumer throws.
+  template <typename F>
+  struct ReleaseGuard {
+    F release;
+    ~ReleaseGuard() { release(); }
+  };
+  template <typename F>
+  static ReleaseGuard<F> MakeReleaseGuard(F f) { return ReleaseGuard<F>{std::move(f)}; }
+
+  void PushLocked(const char* msg, std::size_t len) {
     bip::scoped_lock<bip::interprocess_mutex> lock(queue_->mutex);
     while (queue_->count == Capacity) queue_->not_full.wait(lock);
 
     std::size_t i = queue_->tail;
-    queue_->len[i] = msg.size();
-    std::memcpy(queue_->data[i], msg.data(), msg.size());
-    queue_->data[i][msg.size()] = '\0';
+    queue_->len[i] = len;
+    std::memcpy(queue_->data[i], msg, len);
+    queue_->data[i][len] = '\0';
 
     queue_->tail = (queue_->tail + 1) % Capacity;
     ++queue_->count;
+    ++queue_->pending;
     queue_->not_empty.notify_one();
   }
 
-  std::string Pop() {
-    bip::scoped_lock<bip::interprocess_mutex> lock(queue_->mutex);
-    while (queue_->count == 0) queue_->not_empty.wait(lock);
+  template <typename Fn>
+  void ConsumeLocked(Fn&& fn) {
+    std::size_t i = 0;
+    {
+      bip::scoped_lock<bip::interprocess_mutex> lock(queue_->mutex);
+      while (queue_->pending == 0) queue_->not_empty.wait(lock);
+      i = queue_->next;
+      queue_->next = (queue_->next + 1) % Capacity;
+      --queue_->pending;
+    }
 
-    std::size_t i = queue_->head;
-    std::string msg(queue_->data[i], queue_->len[i]);
+    // The slot is ours until released: no other consumer claims it and producers
+    // never write past head, so fn reads it without the lock.
+    auto release = MakeReleaseGuard([this, i] {
+      bip::scoped_lock<bip::interprocess_mutex> lock(queue_->mutex);
+      queue_->released[i] = true;
+      bool freed = false;
+      while (queue_->count > 0 && queue_->released[queue_->head]) {
+        queue_->released[queue_->head] = false;
+        queue_->head = (queue_->head + 1) % Capacity;
+        --queue_->count;
+        freed = true;
+      }
+      if (freed) queue_->not_full.notify_all();
+    });
+    fn(static_cast<const char*>(queue_->data[i]), queue_->len[i]);
+  }
 
-    queue_->head = (queue_->head + 1) % Capacity;
-    --queue_->count;
-    queue_->not_full.notify_one();
-    return msg;
+  void PushSpsc(const char* msg, std::size_t len) {
+    // Only this process writes tail, so a relaxed load is enough.
+    const std::size_t tail = queue_->tail.load(std::memory_order_relaxed);
+
+    // cached_head_ lets the producer skip the consumer's cache line until the
+    // ring looks full.
+    if (tail - cached_head_ == Capacity) {
+      SpinBackoff backoff;
+      while (tail - (cached_head_ = queue_->head.load(std::memory_order_acquire)) == Capacity) {
+        backoff.Pause();
+      }
+    }
+
+    const std::size_t i = tail % Capacity;
+    queue_->len[i] = len;
+    std::memcpy(queue_->data[i], msg, len);
+    queue_->data[i][len] = '\0';
+
+    queue_->tail.store(tail + 1, std::memory_order_release);
+  }
+
+  template <typename Fn>
+  void ConsumeSpsc(Fn&& fn) {
+    const std::size_t head = queue_->head.load(std::memory_order_relaxed);
+
+    if (cached_tail_ == head) {
+      SpinBackoff backoff;
+      while ((cached_tail_ = queue_->tail.load(std::memory_order_acquire)) == head) {
+        backoff.Pause();
+      }
+    }
+
+    const std::size_t i = head % Capacity;
+    auto release = MakeReleaseGuard([this, head] {
+      queue_->head.store(head + 1, std::memory_order_release);
+    });
+    fn(static_cast<const char*>(queue_->data[i]), queue_->len[i]);
   }
 
- private:
   std::string name_;
   bip::shared_memory_object shm_;
   bip::mapped_region region_;
   Queue* queue_ = nullptr;
+
+  // Process-local copies of the other side's index (SPSC mode only).
+  std::size_t cached_head_ = 0;
+  std::size_t cached_tail_ = 0;
 };
 
 #endif
@@ -0,0 +1,102 @@
+#ifndef SHUTDOWN_SIGNALS_HPP
+#define SHUTDOWN_SIGNALS_HPP
+
+#include <pthread.h>
+
+#include <atomic>
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// SIGINT/SIGTERM as a request for a clean shutdown, and SIGUSR1 as a request for a
+// status dump. The signals are taken by a sigwait thread rather than a signal
+// handler, so the callbacks may lock, allocate and print.
+//
+// Construct it before any other thread starts: the signals are blocked here and the
+// threads inherit the mask, so only this object's thread ever receives them. A
+// second SIGINT/SIGTERM terminates the process the default way, in case the clean
+// shutdown hangs.
+class ShutdownSignals {
+ public:
+  using Handler = std::function<void()>;
+
+  ShutdownSignals() {
+    sigset_t set = Signals();
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  ~ShutdownSignals() {
+    done_.store(true, std::memory_order_relaxed);
+    pthread_kill(thread_.native_handle(), SIGUSR2);
+    thread_.join();
+  }
+
+  ShutdownSignals(const ShutdownSignals&) = delete;
+  ShutdownSignals& operator=(const ShutdownSignals&) = delete;
+
+  // Runs on the signal thread when shutdown is requested, or at once (on this
+  // thread) if it already has been. Replaces the previous handler; clear it before
+  // whatever it refers to goes away (this waits for a handler still running).
+  void OnShutdown(Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_shutdown_ = std::move(handler);
+    if (Requested() && on_shutdown_) on_shutdown_();
+  }
+
+  // Runs on the signal thread for every SIGUSR1.
+  void OnStatus(Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_status_ = std::move(handler);
+  }
+
+  bool Requested() const { return requested_.load(std::memory_order_relaxed); }
+
+ private:
+  static sigset_t Signals() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGUSR1);
+    sigaddset(&set, SIGUSR2);  // wakes the thread for the destructor
+    return set;
+  }
+
+  void Run() {
+    const sigset_t set = Signals();
+    while (!done_.load(std::memory_order_relaxed)) {
+      int sig = 0;
+      if (sigwait(&set, &sig) != 0 || sig == SIGUSR2) continue;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (sig == SIGUSR1) {
+        if (on_status_) on_status_();
+        continue;
+      }
+      if (requested_.exchange(true, std::memory_order_relaxed)) {
+        std::cerr << "Second shutdown signal: terminating\n";
+        std::signal(sig, SIG_DFL);
+        sigset_t one;
+        sigemptyset(&one);
+        sigaddset(&one, sig);
+        pthread_sigmask(SIG_UNBLOCK, &one, nullptr);
+        std::raise(sig);
+      }
+      std::cerr << "Shutting down\n";
+      if (on_shutdown_) on_shutdown_();
+    }
+  }
+
+  std::mutex mutex_;  // guards the handlers; held while one runs
+  Handler on_shutdown_;
+  Handler on_status_;
+  std::atomic<bool> requested_{false};
+  std::atomic<bool> done_{false};
+  std::thread thread_;
+};
+
+#endif
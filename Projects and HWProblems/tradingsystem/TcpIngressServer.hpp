@@ -0,0 +1,141 @@
+#ifndef TCP_INGRESS_SERVER_HPP
+#define TCP_INGRESS_SERVER_HPP
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TcpLineSocket.hpp"
+
+// Asynchronous line ingress: one io_context serves any number of listening ports,
+// each accepting any number of clients, on one or a few event-loop threads. Every
+// connection reads into its own LineBuffer. A port's connections all run on that
+// port's strand, so its line handler never runs concurrently with itself (the same
+// guarantee as one blocking thread per feed); different ports may run in parallel
+// when there is more than one thread.
+class TcpIngressServer {
+ public:
+  // Called with each line; the view is only valid during the call. Must not throw.
+  using LineHandler = std::function<void(std::string_view)>;
+  // Called on the port's strand when a client disconnects, with its address.
+  using CloseHandler = std::function<void(const std::string&)>;
+
+  explicit TcpIngressServer(std::size_t threads = 1, std::size_t buffer_bytes = LineBuffer::kDefaultBytes)
+      : threads_(threads ? threads : 1), buffer_bytes_(buffer_bytes), work_(boost::asio::make_work_guard(io_)) {}
+
+  TcpIngressServer(const TcpIngressServer&) = delete;
+  TcpIngressServer& operator=(const TcpIngressServer&) = delete;
+
+  ~TcpIngressServer() { Stop(); }
+
+  // Binds port (throws if it cannot) and starts accepting once Run() is called.
+  void Listen(int port, LineHandler on_line, CloseHandler on_close = {}) {
+    listeners_.push_back(std::make_unique<Listener>(io_, port, std::move(on_line), std::move(on_close)));
+    Accept(*listeners_.back());
+  }
+
+  // Runs the event loop on the calling thread and threads-1 more. Returns after Stop().
+  void Run() {
+    std::vector<std::thread> extra;
+    for (std::size_t i = 1; i < threads_; ++i) extra.emplace_back([this] { io_.run(); });
+    io_.run();
+    for (auto& t : extra) t.join();
+  }
+
+  void Stop() { io_.stop(); }
+
+  std::size_t OpenConnections() const { return open_.load(std::memory_order_relaxed); }
+  std::uint64_t AcceptedConnections() const { return accepted_.load(std::memory_order_relaxed); }
+
+ private:
+  using tcp = boost::asio::ip::tcp;
+  using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+  struct Listener {
+    Listener(boost::asio::io_context& io, int p, LineHandler line, CloseHandler close)
+        : port(p),
+          strand(boost::asio::make_strand(io)),
+          acceptor(strand, tcp::endpoint(tcp::v4(), static_cast<unsigned short>(p))),
+          on_line(std::move(line)),
+          on_close(std::move(close)) {}
+
+    int port;
+    Strand strand;
+    tcp::acceptor acceptor;
+    LineHandler on_line;
+    CloseHandler on_close;
+  };
+
+  // One client. Kept alive by its pending read.
+  class Session : public std::enable_shared_from_this<Session> {
+   public:
+    Session(tcp::socket socket, Listener& listener, TcpIngressServer& server)
+        : socket_(std::move(socket)), listener_(listener), server_(server), buf_(server.buffer_bytes_) {
+      boost::system::error_code ec;
+      const auto remote = socket_.remote_endpoint(ec);
+      if (!ec) peer_ = remote.address().to_string() + ":" + std::to_string(remote.port());
+    }
+
+    void Read() {
+      socket_.async_read_some(buf_.Writable(),
+                              [self = shared_from_this()](const boost::system::error_code& ec, std::size_t n) {
+                                self->OnRead(ec, n);
+                              });
+    }
+
+   private:
+    void OnRead(const boost::system::error_code& ec, std::size_t n) {
+      if (!ec) {
+        buf_.Commit(n);
+        buf_.ForEachLine(listener_.on_line);
+        Read();
+        return;
+      }
+      buf_.ForEachLine(listener_.on_line, /*at_eof=*/true);
+      if (ec != boost::asio::error::eof && ec != boost::asio::error::operation_aborted)
+        std::cerr << "[Ingress:" << listener_.port << "] " << peer_ << " read error: " << ec.message() << "\n";
+      server_.open_.fetch_sub(1, std::memory_order_relaxed);
+      if (listener_.on_close) listener_.on_close(peer_);
+    }
+
+    tcp::socket socket_;
+    Listener& listener_;
+    TcpIngressServer& server_;
+    LineBuffer buf_;
+    std::string peer_ = "?";
+  };
+
+  void Accept(Listener& l) {
+    // The socket is bound to the port's strand, so its reads complete there.
+    l.acceptor.async_accept(l.strand, [this, &l](const boost::system::error_code& ec, tcp::socket socket) {
+      if (ec == boost::asio::error::operation_aborted) return;
+      if (ec) {
+        std::cerr << "[Ingress:" << l.port << "] accept error: " << ec.message() << "\n";
+      } else {
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        open_.fetch_add(1, std::memory_order_relaxed);
+        std::make_shared<Session>(std::move(socket), l, *this)->Read();
+      }
+      Accept(l);
+    });
+  }
+
+  std::size_t threads_;
+  std::size_t buffer_bytes_;
+  boost::asio::io_context io_;  // before the listeners, whose acceptors use it
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+  std::vector<std::unique_ptr<Listener>> listeners_;
+  std::atomic<std::size_t> open_{0};
+  std::atomic<std::uint64_t> accepted_{0};
+};
+
+#endif
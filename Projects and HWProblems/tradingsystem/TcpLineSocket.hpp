@@ -2,44 +2,125 @@
 #define TCP_LINE_SOCKET_HPP
 
 #include <boost/asio.hpp>
-#include <string>
+#include <cstddef>
+#include <cstring>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Receive buffer for a newline-delimited byte stream. Bytes are read straight into
+// Writable(), lines are split in place with memchr, and a partial line at the end
+// is moved to the front before the next read. A trailing '\r' is dropped.
+class LineBuffer {
+ public:
+  static constexpr std::size_t kDefaultBytes = 256 * 1024;
+
+  explicit LineBuffer(std::size_t bytes = kDefaultBytes) : buf_(bytes) {}
+
+  // Space for the next read, after compacting (and growing the buffer if a single
+  // line fills it).
+  boost::asio::mutable_buffer Writable() {
+    if (begin_ > 0) {
+      std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+      end_ -= begin_;
+      begin_ = 0;
+    }
+    if (end_ == buf_.size()) buf_.resize(buf_.size() * 2);
+    return boost::asio::buffer(buf_.data() + end_, buf_.size() - end_);
+  }
+
+  void Commit(std::size_t n) { end_ += n; }
+
+  void Clear() { begin_ = end_ = 0; }
+
+  // Next complete line, as a view valid until the next Writable(); with at_eof, an
+  // unterminated remainder counts as one.
+  std::optional<std::string_view> NextLine(bool at_eof = false) {
+    if (begin_ == end_) return std::nullopt;
+    const char* first = buf_.data() + begin_;
+    const char* nl = static_cast<const char*>(std::memchr(first, '\n', end_ - begin_));
+    std::size_t len;
+    if (nl) {
+      len = static_cast<std::size_t>(nl - first);
+      begin_ += len + 1;
+    } else if (at_eof) {
+      len = end_ - begin_;
+      begin_ = end_;
+    } else {
+      return std::nullopt;
+    }
+    if (len && first[len - 1] == '\r') --len;
+    return std::string_view(first, len);
+  }
+
+  // on_line(std::string_view) for every complete line buffered.
+  template <typename OnLine>
+  void ForEachLine(OnLine&& on_line, bool at_eof = false) {
+    while (auto line = NextLine(at_eof)) on_line(*line);
+  }
 
+ private:
+  std::vector<char> buf_;
+  std::size_t begin_ = 0;  // first unconsumed byte
+  std::size_t end_ = 0;    // end of bytes read
+};
+
+// Reads lines from one accepted client at a time, blocking, through a LineBuffer.
 class TcpLineServer {
  public:
-  TcpLineServer(boost::asio::io_context& io, int port)
+  TcpLineServer(boost::asio::io_context& io, int port, std::size_t buffer_bytes = LineBuffer::kDefaultBytes)
       : acceptor_(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
-        socket_(io) {}
+        socket_(io),
+        buf_(buffer_bytes) {}
 
   void AcceptOne() {
     // if you re-accept after a disconnect, ensure the socket is closed first
     if (socket_.is_open()) socket_.close();
+    buf_.Clear();
     acceptor_.accept(socket_);
   }
 
+  // Bulk mode: one read, then on_line(std::string_view) for every complete line
+  // buffered. The views point into the buffer and are only valid during the call.
+  // Returns false once the peer has closed (after handing over a final line that
+  // had no newline).
+  template <typename OnLine>
+  bool ReadLines(OnLine&& on_line) {
+    const bool open = Fill();
+    buf_.ForEachLine(on_line, !open);
+    return open;
+  }
+
+  // One line at a time, as a copy; std::nullopt once the peer has closed.
   std::optional<std::string> ReadLine() {
-    boost::system::error_code ec;
-    boost::asio::read_until(socket_, buf_, "\n", ec);
+    for (;;) {
+      if (auto line = buf_.NextLine()) return std::string(*line);
+      if (!Fill()) {
+        if (auto line = buf_.NextLine(true)) return std::string(*line);
+        return std::nullopt;
+      }
+    }
+  }
 
+ private:
+  // One read_some into the buffer. False on EOF.
+  bool Fill() {
+    boost::system::error_code ec;
+    const std::size_t n = socket_.read_some(buf_.Writable(), ec);
     if (ec == boost::asio::error::eof) {
       // peer closed; close our side so AcceptOne can be called again safely
       socket_.close();
-      return std::nullopt;
+      return false;
     }
     if (ec) throw boost::system::system_error(ec);
-
-    std::istream is(&buf_);
-    std::string line;
-    std::getline(is, line);
-
-    if (!line.empty() && line.back() == '\r') line.pop_back();
-    return line;
+    buf_.Commit(n);
+    return true;
   }
 
- private:
   boost::asio::ip::tcp::acceptor acceptor_;
   boost::asio::ip::tcp::socket socket_;
-  boost::asio::streambuf buf_;
+  LineBuffer buf_;
 };
 
 
@@ -58,6 +139,11 @@ class TcpLineClient {
     boost::asio::write(socket_, boost::asio::buffer(msg));
   }
 
+  // Writes bytes as-is; the caller supplies any newline.
+  void Write(std::string_view bytes) {
+    boost::asio::write(socket_, boost::asio::buffer(bytes.data(), bytes.size()));
+  }
+
  private:
   boost::asio::ip::tcp::socket socket_;
 };
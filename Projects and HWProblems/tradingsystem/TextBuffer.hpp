@@ -0,0 +1,70 @@
+#ifndef TEXT_BUFFER_HPP
+#define TEXT_BUFFER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Growable output buffer for the line serializers. Owners keep one per connector and
+// Clear() it per message, so once it has grown to the longest line no further
+// allocation happens. Numbers are written with std::to_chars (no locale, no streams).
+class TextBuffer {
+ public:
+  explicit TextBuffer(std::size_t reserve = 256) { buf_.resize(reserve); }
+
+  void Clear() { size_ = 0; }
+
+  const char* Data() const { return buf_.data(); }
+  std::size_t Size() const { return size_; }
+  std::string_view View() const { return std::string_view(buf_.data(), size_); }
+  std::string Str() const { return std::string(buf_.data(), size_); }
+
+  TextBuffer& Append(char c) {
+    *Reserve(1) = c;
+    ++size_;
+    return *this;
+  }
+
+  TextBuffer& Append(std::string_view s) {
+    std::memcpy(Reserve(s.size()), s.data(), s.size());
+    size_ += s.size();
+    return *this;
+  }
+
+  TextBuffer& Append(const char* s) { return Append(std::string_view(s)); }
+  TextBuffer& Append(const std::string& s) { return Append(std::string_view(s)); }
+
+  TextBuffer& AppendInt(long long v) {
+    char* p = Reserve(kMaxIntChars);
+    size_ += static_cast<std::size_t>(std::to_chars(p, p + kMaxIntChars, v).ptr - p);
+    return *this;
+  }
+
+  // Same text as `ostream << v` with default flags (%g, 6 significant digits).
+  TextBuffer& AppendDouble(double v) {
+    char* p = Reserve(kMaxDoubleChars);
+    size_ += static_cast<std::size_t>(std::to_chars(p, p + kMaxDoubleChars, v, std::chars_format::general, 6).ptr - p);
+    return *this;
+  }
+
+  // Raw write access for custom formatters: write at most max_len bytes at the
+  // returned pointer, then Commit(end).
+  char* Reserve(std::size_t max_len) {
+    if (size_ + max_len > buf_.size()) buf_.resize((size_ + max_len) * 2);
+    return buf_.data() + size_;
+  }
+
+  void Commit(const char* end) { size_ = static_cast<std::size_t>(end - buf_.data()); }
+
+ private:
+  static constexpr std::size_t kMaxIntChars = 24;
+  static constexpr std::size_t kMaxDoubleChars = 32;
+
+  std::vector<char> buf_;
+  std::size_t size_ = 0;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef TIMESTAMP_HPP
+#define TIMESTAMP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIMESTAMP_HAS_TSC 1
+#elif defined(__aarch64__)
+#define TIMESTAMP_HAS_TSC 1
+#else
+#define TIMESTAMP_HAS_TSC 0
+#endif
+
+// Wall-clock timestamps (epoch nanoseconds) for the writers and instrumentation.
+//
+//   kSystem  std::chrono::system_clock, one vDSO call per read.
+//   kCoarse  CLOCK_REALTIME_COARSE where available: cheaper, but only advances once
+//            per kernel tick (1-4 ms), so fine for ms CSV stamps, not for latency.
+//   kTsc     the CPU cycle counter (rdtsc / cntvct_el0), scaled by a rate measured
+//            against system_clock the first time it is used (about 10 ms, once)
+//            and anchored to the epoch then. Assumes an invariant counter, as on
+//            any recent x86 or ARM; it drifts from NTP time at the crystal's ppm.
+//
+// The mode is process-wide; set it before the threads start. On top of that a
+// TimestampBatch pins "now" for the current thread, so everything one inbound
+// message produces carries the same stamp and reads the clock once.
+enum class TimestampMode : std::uint8_t { kSystem, kCoarse, kTsc };
+
+class TimestampClock {
+ public:
+  static void SetMode(TimestampMode mode) { ModeRef().store(mode, std::memory_order_relaxed); }
+  static TimestampMode Mode() { return ModeRef().load(std::memory_order_relaxed); }
+
+  // Uncached epoch nanoseconds in the current mode.
+  static std::int64_t NowNs() {
+    switch (Mode()) {
+      case TimestampMode::kTsc: return TscNowNs();
+      case TimestampMode::kCoarse: return CoarseNowNs();
+      case TimestampMode::kSystem: break;
+    }
+    return SystemNowNs();
+  }
+
+  static std::int64_t SystemNowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+  }
+
+  static std::int64_t CoarseNowNs() {
+#if defined(CLOCK_REALTIME_COARSE)
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return SystemNowNs();
+#endif
+  }
+
+  static std::int64_t TscNowNs() {
+#if TIMESTAMP_HAS_TSC
+    const TscCalibration& c = Calibration();
+    return c.base_ns + static_cast<std::int64_t>(static_cast<double>(ReadTsc() - c.base_ticks) * c.ns_per_tick);
+#else
+    return SystemNowNs();
+#endif
+  }
+
+  // Counter ticks per second, as calibrated (0 without a counter).
+  static double TscHz() {
+#if TIMESTAMP_HAS_TSC
+    return 1e9 / Calibration().ns_per_tick;
+#else
+    return 0;
+#endif
+  }
+
+ private:
+  static std::atomic<TimestampMode>& ModeRef() {
+    static std::atomic<TimestampMode> mode{TIMESTAMP_HAS_TSC ? TimestampMode::kTsc : TimestampMode::kSystem};
+    return mode;
+  }
+
+#if TIMESTAMP_HAS_TSC
+  struct TscCalibration {
+    std::uint64_t base_ticks;
+    std::int64_t base_ns;
+    double ns_per_tick;
+  };
+
+  static std::uint64_t ReadTsc() {
+#if defined(__aarch64__)
+    std::uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return __rdtsc();
+#endif
+  }
+
+  // Counter and system_clock sampled back to back; the tighter pair of two tries
+  // keeps a preemption between the reads out of the anchor.
+  static void Sample(std::uint64_t& ticks, std::int64_t& ns) {
+    std::uint64_t best = ~std::uint64_t{0};
+    for (int i = 0; i < 2; ++i) {
+      const std::uint64_t t0 = ReadTsc();
+      const std::int64_t n = SystemNowNs();
+      const std::uint64_t t1 = ReadTsc();
+      if (t1 - t0 < best) {
+        best = t1 - t0;
+        ticks = t0 + (t1 - t0) / 2;
+        ns = n;
+      }
+    }
+  }
+
+  static TscCalibration Calibrate() {
+    std::uint64_t t0 = 0, t1 = 0;
+    std::int64_t n0 = 0, n1 = 0;
+    Sample(t0, n0);
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+    Sample(t1, n1);
+    return TscCalibration{t1, n1, static_cast<double>(n1 - n0) / static_cast<double>(t1 - t0)};
+  }
+
+  static const TscCalibration& Calibration() {
+    static const TscCalibration c = Calibrate();
+    return c;
+  }
+#endif
+};
+
+namespace timestamp_detail {
+inline thread_local std::int64_t batch_ns = 0;  // 0: no batch open on this thread
+}
+
+// Pins "now" for this thread until destroyed. Nests: an inner batch keeps the
+// outer one's time.
+class TimestampBatch {
+ public:
+  TimestampBatch() : owner_(timestamp_detail::batch_ns == 0) {
+    if (owner_) timestamp_detail::batch_ns = TimestampClock::NowNs();
+  }
+  ~TimestampBatch() {
+    if (owner_) timestamp_detail::batch_ns = 0;
+  }
+
+  TimestampBatch(const TimestampBatch&) = delete;
+  TimestampBatch& operator=(const TimestampBatch&) = delete;
+
+ private:
+  bool owner_;
+};
+
+// Epoch nanoseconds: the open batch's time, else a clock read.
+inline std::int64_t TimestampNs() {
+  const std::int64_t t = timestamp_detail::batch_ns;
+  return t ? t : TimestampClock::NowNs();
+}
+
+inline long long TimestampMs() { return TimestampNs() / 1000000; }
+
+#endif
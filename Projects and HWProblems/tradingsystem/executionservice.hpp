@@ -25,7 +25,7 @@ class ExecutionOrder
 public:
 
     // ctor for an order
-    ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, double _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder);
+    ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, PriceTicks _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder);
 
     // Get the product
     const T& GetProduct() const;
@@ -39,7 +39,7 @@ public:
     OrderType GetOrderType() const;
 
     // Get the price on this order
-    double GetPrice() const;
+    PriceTicks GetPrice() const;
 
     // Get the visible quantity on this order
     long GetVisibleQuantity() const;
@@ -54,11 +54,11 @@ public:
     bool IsChildOrder() const;
 
 private:
-    T product;
+    const T* product;
     PricingSide side;
     string orderId;
     OrderType orderType;
-    double price;
+    PriceTicks price;
     double visibleQuantity;
     double hiddenQuantity;
     string parentOrderId;
@@ -83,8 +83,8 @@ public:
 };
 
 template<typename T>
-ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, double _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder) :
-  product(_product)
+ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, PriceTicks _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder) :
+  product(&_product)
 {
   side = _side;
   orderId = _orderId;
@@ -99,7 +99,7 @@ ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, string _
 template<typename T>
 const T& ExecutionOrder<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -121,7 +121,7 @@ OrderType ExecutionOrder<T>::GetOrderType() const
 }
 
 template<typename T>
-double ExecutionOrder<T>::GetPrice() const
+PriceTicks ExecutionOrder<T>::GetPrice() const
 {
   return price;
 }
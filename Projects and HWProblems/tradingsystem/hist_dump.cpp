@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "HistoricalJournal.hpp"
+
+// Prints a historical journal (.bhj) as CSV, in the same line layout as the CSV
+// writers. Records are read in place from the mapping.
+//
+// Usage: ./hist_dump <file.bhj> [--ms]   CSV to stdout (--ms: millisecond timestamps,
+//                                         as in the CSV files; default nanoseconds)
+//        ./hist_dump <file.bhj> --info   record type, size, count and schema
+
+namespace {
+
+const char* TypeName(JournalRecordType t) {
+  switch (t) {
+    case JournalRecordType::kPosition: return "position";
+    case JournalRecordType::kBucketPosition: return "bucket_position";
+    case JournalRecordType::kRisk: return "risk";
+    case JournalRecordType::kBucketRisk: return "bucket_risk";
+    case JournalRecordType::kExecution: return "execution";
+    case JournalRecordType::kStreaming: return "streaming";
+    case JournalRecordType::kInquiry: return "inquiry";
+  }
+  return "unknown";
+}
+
+template <typename Record>
+void Dump(const JournalReader& journal, bool to_ms) {
+  const Record* records = journal.Get<Record>();
+  const std::uint64_t n = journal.Count();
+  TextBuffer buf(1 << 16);
+  for (std::uint64_t i = 0; i < n; ++i) {
+    AppendJournalCsv(buf, records[i], to_ms);
+    if (buf.Size() >= (1 << 15)) {
+      std::fwrite(buf.Data(), 1, buf.Size(), stdout);
+      buf.Clear();
+    }
+  }
+  std::fwrite(buf.Data(), 1, buf.Size(), stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.bhj> [--ms | --info]\n";
+    return 1;
+  }
+  const bool to_ms = argc > 2 && std::strcmp(argv[2], "--ms") == 0;
+  const bool info = argc > 2 && std::strcmp(argv[2], "--info") == 0;
+
+  try {
+    JournalReader journal(argv[1]);
+    if (info) {
+      std::cout << "type=" << TypeName(journal.Type()) << " record_size=" << journal.RecordSize()
+                << " records=" << journal.Count() << "\nschema=" << journal.Schema() << "\n";
+      return 0;
+    }
+
+    switch (journal.Type()) {
+      case JournalRecordType::kPosition:
+      case JournalRecordType::kBucketPosition: Dump<PositionJournalRecord>(journal, to_ms); break;
+      case JournalRecordType::kRisk:
+      case JournalRecordType::kBucketRisk: Dump<RiskJournalRecord>(journal, to_ms); break;
+      case JournalRecordType::kExecution: Dump<ExecutionJournalRecord>(journal, to_ms); break;
+      case JournalRecordType::kStreaming: Dump<StreamingJournalRecord>(journal, to_ms); break;
+      case JournalRecordType::kInquiry: Dump<InquiryJournalRecord>(journal, to_ms); break;
+      default: throw std::runtime_error("Unknown journal record type");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << argv[1] << ": " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -24,7 +24,7 @@ class Inquiry
 public:
 
   // ctor for an inquiry
-  Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, double _price, InquiryState _state);
+  Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, PriceTicks _price, InquiryState _state);
 
   // Get the inquiry ID
   const string& GetInquiryId() const;
@@ -39,17 +39,17 @@ public:
   long GetQuantity() const;
 
   // Get the price that we have responded back with
-  double GetPrice() const;
+  PriceTicks GetPrice() const;
 
   // Get the current state on the inquiry
   InquiryState GetState() const;
 
 private:
   string inquiryId;
-  T product;
+  const T* product;
   Side side;
   long quantity;
-  double price;
+  PriceTicks price;
   InquiryState state;
 
 };
@@ -66,7 +66,7 @@ class InquiryService : public Service<string,Inquiry <T> >
 public:
 
   // Send a quote back to the client
-  virtual void SendQuote(const string &inquiryId, double price) = 0;
+  virtual void SendQuote(const string &inquiryId, PriceTicks price) = 0;
 
   // Reject an inquiry from the client
   virtual void RejectInquiry(const string &inquiryId) = 0;
@@ -74,8 +74,8 @@ public:
 };
 
 template<typename T>
-Inquiry<T>::Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, double _price, InquiryState _state) :
-  product(_product)
+Inquiry<T>::Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, PriceTicks _price, InquiryState _state) :
+  product(&_product)
 {
   inquiryId = _inquiryId;
   side = _side;
@@ -93,7 +93,7 @@ const string& Inquiry<T>::GetInquiryId() const
 template<typename T>
 const T& Inquiry<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -109,7 +109,7 @@ long Inquiry<T>::GetQuantity() const
 }
 
 template<typename T>
-double Inquiry<T>::GetPrice() const
+PriceTicks Inquiry<T>::GetPrice() const
 {
   return price;
 }
@@ -1,6 +1,7 @@
+#include <functional>
 #include <iostream>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 
 #include "BondUniverse.hpp"
 
@@ -16,6 +17,10 @@
 #include "BondAlgoStreamingService.hpp"
 #include "GUIService.hpp"
 #include "BondInquiryService.hpp"
+#include "BondSequencer.hpp"
+#include "BondShardedPipeline.hpp"
+#include "BondServiceBridges.hpp"
+#include "BondStaticPipeline.hpp"
 
 // Historical persistence (UPDATED)
 #include "BondHistoricalDataService.hpp"
@@ -24,78 +29,10 @@
 #include "BondMarketDataShmConnectors.hpp"
 #include "BondTypedConnectors.hpp"
 #include "InquiryQuoteLoopbackConnector.hpp"
+#include "LatencyHistogram.hpp"
+#include "ShutdownSignals.hpp"
 #include "BondProductRepository.hpp"
-
-// --------- Bridge listeners (adapters) ----------
-class TradeToPositionListener final : public ServiceListener<Trade<Bond>> {
- public:
-  explicit TradeToPositionListener(BondPositionService& pos) : pos_(pos) {}
-  void ProcessAdd(Trade<Bond>& t) override { pos_.AddTrade(t); }
-  void ProcessUpdate(Trade<Bond>& t) override { pos_.AddTrade(t); }
-  void ProcessRemove(Trade<Bond>&) override {}
-
- private:
-  BondPositionService& pos_;
-};
-
-class PositionToRiskListener final : public ServiceListener<Position<Bond>> {
- public:
-  explicit PositionToRiskListener(BondRiskService& risk) : risk_(risk) {}
-  void ProcessAdd(Position<Bond>& p) override { risk_.AddPosition(p); }
-  void ProcessUpdate(Position<Bond>& p) override { risk_.AddPosition(p); }
-  void ProcessRemove(Position<Bond>&) override {}
-
- private:
-  BondRiskService& risk_;
-};
-
-class AlgoExecToExecutionListener final : public ServiceListener<AlgoExecution> {
- public:
-  explicit AlgoExecToExecutionListener(BondExecutionService& exec) : exec_(exec) {}
-  void ProcessAdd(AlgoExecution& ae) override {
-    ExecutionOrder<Bond> order = ae.GetOrder();
-    exec_.ExecuteOrder(order, BROKERTEC);
-  }
-  void ProcessUpdate(AlgoExecution& ae) override { ProcessAdd(ae); }
-  void ProcessRemove(AlgoExecution&) override {}
-
- private:
-  BondExecutionService& exec_;
-};
-
-class AlgoStreamToStreamingListener final : public ServiceListener<AlgoStream> {
- public:
-  explicit AlgoStreamToStreamingListener(BondStreamingService& stream) : stream_(stream) {}
-  void ProcessAdd(AlgoStream& as) override {
-    PriceStream<Bond> ps = as.GetPriceStream();
-    stream_.PublishPrice(ps);
-  }
-  void ProcessUpdate(AlgoStream& as) override { ProcessAdd(as); }
-  void ProcessRemove(AlgoStream&) override {}
-
- private:
-  BondStreamingService& stream_;
-};
-
-class ExecutionToTradeBookingListener final : public ServiceListener<ExecutionOrder<Bond>> {
- public:
-  explicit ExecutionToTradeBookingListener(BondTradeBookingService& tb) : tb_(tb) {}
-
-  void ProcessAdd(ExecutionOrder<Bond>& eo) override {
-    // Convert executions to trades so PositionService gets updated.
-    static long seq = 1;
-    const std::string trade_id = "T" + std::to_string(seq++);
-    const std::string book = "TRSY1";
-    Side side = (eo.GetSide() == BID ? BUY : SELL);
-    Trade<Bond> trade(eo.GetProduct(), trade_id, eo.GetPrice(), book, eo.GetVisibleQuantity(), side);
-    tb_.BookTrade(trade);
-  }
-  void ProcessUpdate(ExecutionOrder<Bond>& eo) override { ProcessAdd(eo); }
-  void ProcessRemove(ExecutionOrder<Bond>&) override {}
-
- private:
-  BondTradeBookingService& tb_;
-};
+#include "Timestamp.hpp"
 
 // --------- Bucket helpers ----------
 static std::string BucketNameForProductId(const std::string& pid) {
@@ -105,20 +42,50 @@ static std::string BucketNameForProductId(const std::string& pid) {
   return "Unknown";
 }
 
-static std::vector<Bond> BucketProducts(const std::string& bucket) {
+static std::vector<const Bond*> BucketProducts(const std::string& bucket) {
   auto& repo = BondProductRepository::Instance();
-  if (bucket == "FrontEnd") return {repo.Get("2Y"), repo.Get("3Y")};
-  if (bucket == "Belly") return {repo.Get("5Y"), repo.Get("7Y"), repo.Get("10Y")};
-  if (bucket == "LongEnd") return {repo.Get("20Y"), repo.Get("30Y")};
+  if (bucket == "FrontEnd") return {&repo.Get("2Y"), &repo.Get("3Y")};
+  if (bucket == "Belly") return {&repo.Get("5Y"), &repo.Get("7Y"), &repo.Get("10Y")};
+  if (bucket == "LongEnd") return {&repo.Get("20Y"), &repo.Get("30Y")};
   return {};
 }
 
+// Bucket of every product by dense index, plus one prebuilt sector per bucket, so the
+// listeners below do no string work per update.
+class ProductBuckets {
+ public:
+  static constexpr std::size_t kNoBucket = static_cast<std::size_t>(-1);
+
+  ProductBuckets() {
+    const char* names[] = {"FrontEnd", "Belly", "LongEnd"};
+    for (const char* name : names) sectors_.emplace_back(BucketProducts(name), name);
+
+    auto& repo = BondProductRepository::Instance();
+    bucket_of_.assign(repo.Size(), kNoBucket);
+    for (std::size_t i = 0; i < repo.Size(); ++i) {
+      const std::string bucket = BucketNameForProductId(repo.GetByIndex(i).GetProductId());
+      for (std::size_t b = 0; b < sectors_.size(); ++b)
+        if (sectors_[b].GetName() == bucket) bucket_of_[i] = b;
+    }
+  }
+
+  std::size_t Count() const { return sectors_.size(); }
+  std::size_t BucketOf(std::size_t product_index) const {
+    return product_index < bucket_of_.size() ? bucket_of_[product_index] : kNoBucket;
+  }
+  const BucketedSector<Bond>& Sector(std::size_t bucket) const { return sectors_[bucket]; }
+
+ private:
+  std::vector<BucketedSector<Bond>> sectors_;
+  std::vector<std::size_t> bucket_of_;
+};
+
 // --------- Bucketed persistence listeners ----------
 // Maintains running aggregate by bucket and persists Position<BucketedSector<Bond>>.
 class BucketedPositionPersistListener final : public ServiceListener<Position<Bond>> {
  public:
   explicit BucketedPositionPersistListener(BondHistoricalBucketedPositionService& hist)
-      : hist_(hist) {}
+      : hist_(hist), last_qty_(BondProductRepository::Instance().Size(), 0), bucket_qty_(buckets_.Count(), 0) {}
 
   void ProcessAdd(Position<Bond>& p) override { OnPos(p); }
   void ProcessUpdate(Position<Bond>& p) override { OnPos(p); }
@@ -126,34 +93,38 @@ class BucketedPositionPersistListener final : public ServiceListener<Position<Bo
 
  private:
   void OnPos(const Position<Bond>& p) {
-    const std::string pid = p.GetProduct().GetProductId();
-    const std::string bucket = BucketNameForProductId(pid);
-    if (bucket == "Unknown") return;
+    const std::size_t idx = ProductIndexOf(p.GetProduct());
+    const std::size_t bucket = buckets_.BucketOf(idx);
+    if (bucket == ProductBuckets::kNoBucket) return;
 
     const long new_qty = p.GetAggregatePosition();
-    const long old_qty = last_qty_by_pid_[pid];
-    const long delta = new_qty - old_qty;
-    last_qty_by_pid_[pid] = new_qty;
+    const long delta = new_qty - last_qty_[idx];
+    last_qty_[idx] = new_qty;
 
     bucket_qty_[bucket] += delta;
 
-    BucketedSector<Bond> sector(BucketProducts(bucket), bucket);
+    const BucketedSector<Bond>& sector = buckets_.Sector(bucket);
     Position<BucketedSector<Bond>> bucket_pos(sector);
     bucket_pos.SetPosition("AGG", bucket_qty_[bucket]);
 
-    hist_.PersistData(bucket, bucket_pos);
+    hist_.PersistData(sector.GetName(), bucket_pos);
   }
 
   BondHistoricalBucketedPositionService& hist_;
-  std::unordered_map<std::string, long> last_qty_by_pid_;
-  std::unordered_map<std::string, long> bucket_qty_;
+  ProductBuckets buckets_;
+  std::vector<long> last_qty_;    // by product index
+  std::vector<long> bucket_qty_;  // by bucket
 };
 
 // Maintains running aggregate by bucket and persists PV01<BucketedSector<Bond>>.
 class BucketedRiskPersistListener final : public ServiceListener<PV01<Bond>> {
  public:
   explicit BucketedRiskPersistListener(BondHistoricalBucketedRiskService& hist)
-      : hist_(hist) {}
+      : hist_(hist),
+        last_contrib_(BondProductRepository::Instance().Size(), 0.0),
+        last_qty_(BondProductRepository::Instance().Size(), 0),
+        bucket_pv01_(buckets_.Count(), 0.0),
+        bucket_qty_(buckets_.Count(), 0) {}
 
   void ProcessAdd(PV01<Bond>& r) override { OnRisk(r); }
   void ProcessUpdate(PV01<Bond>& r) override { OnRisk(r); }
@@ -161,74 +132,226 @@ class BucketedRiskPersistListener final : public ServiceListener<PV01<Bond>> {
 
  private:
   void OnRisk(const PV01<Bond>& r) {
-    const std::string pid = r.GetProduct().GetProductId();
-    const std::string bucket = BucketNameForProductId(pid);
-    if (bucket == "Unknown") return;
+    const std::size_t idx = ProductIndexOf(r.GetProduct());
+    const std::size_t bucket = buckets_.BucketOf(idx);
+    if (bucket == ProductBuckets::kNoBucket) return;
 
     // contribution = pv01_per_unit * qty
     const double new_contrib = r.GetPV01() * static_cast<double>(r.GetQuantity());
-    const double old_contrib = last_contrib_by_pid_[pid];
-    const double delta = new_contrib - old_contrib;
-    last_contrib_by_pid_[pid] = new_contrib;
+    const double delta = new_contrib - last_contrib_[idx];
+    last_contrib_[idx] = new_contrib;
 
     // quantities
     const long new_qty = r.GetQuantity();
-    const long old_qty = last_qty_by_pid_[pid];
-    last_qty_by_pid_[pid] = new_qty;
+    const long old_qty = last_qty_[idx];
+    last_qty_[idx] = new_qty;
 
     bucket_pv01_[bucket] += delta;
     bucket_qty_[bucket] += (new_qty - old_qty);
 
-    BucketedSector<Bond> sector(BucketProducts(bucket), bucket);
+    const BucketedSector<Bond>& sector = buckets_.Sector(bucket);
     PV01<BucketedSector<Bond>> bucket_risk(sector, bucket_pv01_[bucket], bucket_qty_[bucket]);
 
-    hist_.PersistData(bucket, bucket_risk);
+    hist_.PersistData(sector.GetName(), bucket_risk);
   }
 
   BondHistoricalBucketedRiskService& hist_;
-  std::unordered_map<std::string, double> last_contrib_by_pid_;
-  std::unordered_map<std::string, long> last_qty_by_pid_;
-  std::unordered_map<std::string, double> bucket_pv01_;
-  std::unordered_map<std::string, long> bucket_qty_;
+  ProductBuckets buckets_;
+  std::vector<double> last_contrib_;  // by product index
+  std::vector<long> last_qty_;
+  std::vector<double> bucket_pv01_;   // by bucket
+  std::vector<long> bucket_qty_;
 };
 
-int main() {
+// Starts the inbound feeds, delivering to the given targets (the services themselves,
+// or a sequencer's queues). Market data has its own SHM thread; the TCP feeds share
+// one async ingress, run on the calling thread, which accepts any number of clients
+// per port. Blocks until SIGINT/SIGTERM stops them; whatever they delivered is then
+// left for the caller to drain. on_shutdown runs first, on the signal thread.
+template <typename MarketDataT, typename PricingT, typename TradesT, typename InquiriesT>
+void RunInboundFeeds(ShutdownSignals& signals, const std::function<void()>& on_shutdown, MarketDataT& marketdata,
+                     PricingT& pricing, TradesT& trades, InquiriesT& inquiries) {
+  BondMarketDataShmSubscriber<MarketDataT> md_in(marketdata, "BOND_MD_SHM");
+  auto px_in = MakePricingInbound(pricing, 9001);
+  auto tr_in = MakeTradesInbound(trades, 9002);
+  auto iq_in = MakeInquiriesInbound(inquiries, 9003);
+
+  TcpIngressServer ingress;
+  px_in.Listen(ingress);
+  tr_in.Listen(ingress);
+  iq_in.Listen(ingress);
+
+  std::thread t_md([&] { md_in.Subscribe(); });
+
+  std::cout << "Trading system running.\n"
+            << "Ports: prices=9001 trades=9002 inquiries=9003\n"
+            << "Outbound: executions=9101 streaming=9102\n"
+            << "Market data SHM name: BOND_MD_SHM\n";
+
+  signals.OnShutdown([&] {
+    on_shutdown();
+    ingress.Stop();
+    md_in.Stop();
+  });
+  ingress.Run();
+  md_in.Stop();
+  t_md.join();
+  signals.OnShutdown({});
+}
+
+// Usage: ./trading_system [sequenced|direct] [priority] [--journal] [--clock=MODE] [--latency]
+//                         [--per_product_algo]
+//        ./trading_system sharded [shards] [priority] [--journal] [--clock=MODE] [--latency]
+//   sequenced (default): feeds only parse and enqueue; one sequencer thread drives
+//                        every service, draining the queues in priority order
+//                        (default md,tr,px,iq)
+//   direct             : each feed thread calls straight into its service
+//   sharded            : products split across shards (default 2), each with its
+//                        own services and sequencer thread; one merge thread does
+//                        persistence and the bucketed aggregates; the algo
+//                        services alternate buy/sell and 1mm/2mm per product
+//   --journal          : historical data as binary journals (*.bhj, see hist_dump)
+//                        instead of CSV
+//   --clock=MODE       : timestamp source, tsc (default where available), coarse
+//                        or system (see Timestamp.hpp)
+//   --latency          : per-stage latency histograms from ingress, printed on
+//                        SIGUSR1 and at exit (see LatencyHistogram.hpp)
+//   --per_product_algo : sequenced/direct alternate per product as sharded mode
+//                        does, instead of across all products, so the outputs of
+//                        the modes can be compared
+// SIGINT/SIGTERM stop the feeds, drain what they queued, flush the historical files
+// and outbound sockets, and exit; a second one kills the process outright.
+int main(int argc, char** argv) {
+  bool journal = false;
+  AlgoAlternation alternation = AlgoAlternation::kGlobal;
+  for (; argc > 1 && std::string(argv[argc - 1]).rfind("--", 0) == 0; --argc) {
+    const std::string flag = argv[argc - 1];
+    if (flag == "--journal") journal = true;
+    else if (flag == "--latency") LatencyStats::Enable();
+    else if (flag == "--per_product_algo") alternation = AlgoAlternation::kPerProduct;
+    else if (flag == "--clock=tsc") TimestampClock::SetMode(TimestampMode::kTsc);
+    else if (flag == "--clock=coarse") TimestampClock::SetMode(TimestampMode::kCoarse);
+    else if (flag == "--clock=system") TimestampClock::SetMode(TimestampMode::kSystem);
+    else {
+      std::cerr << "Unknown option " << flag << "\n";
+      return 1;
+    }
+  }
+
+  const std::string mode = argc > 1 ? argv[1] : "sequenced";
+  const bool sharded = mode == "sharded";
+  if (mode != "sequenced" && mode != "direct" && !sharded) {
+    std::cerr << "Usage: " << argv[0] << " [sequenced|direct] [priority e.g. md,tr,px,iq] [--journal] [--clock=tsc|coarse|system] [--latency] [--per_product_algo]\n"
+              << "       " << argv[0] << " sharded [shards] [priority] [--journal] [--clock=tsc|coarse|system] [--latency]\n";
+    return 1;
+  }
+  std::size_t shards = 2;
+  SequencerPriority priority = kDefaultSequencerPriority;
+  try {
+    if (sharded && argc > 2) shards = static_cast<std::size_t>(std::stoul(argv[2]));
+    const int priority_arg = sharded ? 3 : 2;
+    if (argc > priority_arg) priority = ParseSequencerPriority(argv[priority_arg]);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+
+  // Before any thread starts, so they all leave the signals to it.
+  ShutdownSignals signals;
+  if (LatencyStats::Enabled()) signals.OnStatus([] { LatencyStats::Print(std::cerr); });
+  auto print_latency = [] {
+    if (LatencyStats::Enabled()) LatencyStats::Print(std::cerr);
+  };
+
   RegisterBondUniverse();
+  TimestampNs();  // calibrates the TSC before the feeds start
 
-  // ---------- Services ----------
-  BondPricingService pricing_svc;
-  BondMarketDataService marketdata_svc;
-  BondTradeBookingService tradebooking_svc;
-  BondPositionService position_svc;
-  BondRiskService risk_svc;
+  // ---------- Historical persistence ----------
+  // CSV files are written in batches by the async writer's thread, not by the
+  // services; journals are appended in place.
+  AsyncHistoricalWriter hist_writer;
+  const HistoricalFormat hist_format = journal ? HistoricalFormat::kJournal : HistoricalFormat::kCsv;
+  auto hist_file = [&](const std::string& name) { return name + (journal ? ".bhj" : ".txt"); };
+  BondHistoricalPositionService hist_pos(hist_file("positions"), hist_format, &hist_writer);
+  BondHistoricalBucketedPositionService hist_bpos(hist_file("positions_bucketed"), hist_format, &hist_writer);
+  BondHistoricalRiskService hist_risk(hist_file("risk"), hist_format, &hist_writer);
+  BondHistoricalBucketedRiskService hist_brisk(hist_file("risk_bucketed"), hist_format, &hist_writer);
+  BondHistoricalExecutionService hist_exec(hist_file("executions"), hist_format, &hist_writer);
+  BondHistoricalStreamingService hist_stream(hist_file("streaming"), hist_format, &hist_writer);
+  BondHistoricalInquiryService hist_inq(hist_file("allinquiries"), hist_format, &hist_writer);
 
-  BondAlgoExecutionService algo_exec_svc;
-  BondExecutionService execution_svc;
+  PersistToHistoricalListener<Position<Bond>> persist_pos(hist_pos);
+  PersistToHistoricalListener<PV01<Bond>> persist_risk(hist_risk);
+  PersistToHistoricalListener<ExecutionOrder<Bond>> persist_exec(hist_exec);
+  PersistToHistoricalListener<PriceStream<Bond>> persist_stream(hist_stream);
+  PersistToHistoricalListener<Inquiry<Bond>> persist_inq(hist_inq);
 
-  BondAlgoStreamingService algo_stream_svc;
-  BondStreamingService streaming_svc;
+  BucketedPositionPersistListener persist_bpos(hist_bpos);
+  BucketedRiskPersistListener persist_brisk(hist_brisk);
 
   GUIService gui_svc("gui.txt", std::chrono::milliseconds(300));
-  BondInquiryService inquiry_svc;
 
-  // ---------- Service wiring ----------
-  // TradeBooking -> Position -> Risk
-  TradeToPositionListener trade_to_pos(position_svc);
-  PositionToRiskListener pos_to_risk(risk_svc);
-  tradebooking_svc.AddListener(&trade_to_pos);
-  position_svc.AddListener(&pos_to_risk);
+  // ---------- Outbound sockets (exec_print / stream_print) ----------
+  // Written by the connectors' own threads; reconnects while the printers are down.
+  // Executions wait for a slow or missing printer; streams keep the newest quote per
+  // product.
+  OutboundOptions stream_options;
+  stream_options.overflow = OutboundOverflow::kConflate;
+  auto exec_out = MakeAsyncExecutionOutbound("127.0.0.1", 9101);
+  auto stream_out = MakeAsyncStreamingOutbound("127.0.0.1", 9102, stream_options);
+  // At shutdown, stop waiting for a missing exec_print.
+  const std::function<void()> release_outbound = [&] { exec_out.StopWaiting(); };
+
+  if (sharded) {
+    BondShardedPipeline pipeline(shards, priority);
+    BondMergeStage& merge = pipeline.Merge();
+    merge.executions.AddListener(&persist_exec);
+    merge.positions.AddListener(&persist_pos);
+    merge.positions.AddListener(&persist_bpos);
+    merge.risk.AddListener(&persist_risk);
+    merge.risk.AddListener(&persist_brisk);
+    merge.streams.AddListener(&persist_stream);
+    merge.inquiries.AddListener(&persist_inq);
+    merge.prices.AddListener(&gui_svc);
+    for (std::size_t i = 0; i < pipeline.ShardCount(); ++i) {
+      pipeline.Shard(i).pipeline.execution.SetPublishConnector(&exec_out);
+      pipeline.Shard(i).streaming.SetPublishConnector(&stream_out);
+    }
+
+    std::cout << "Sharded: " << pipeline.ShardCount() << " shards\n";
+    pipeline.Start();
+    RunInboundFeeds(signals, release_outbound, pipeline.MarketDataInbound(), pipeline.PricingInbound(),
+                    pipeline.TradesInbound(), pipeline.InquiriesInbound());
+    pipeline.Stop();
+    pipeline.PrintDepths(std::cerr);
+    print_latency();
+    return 0;
+  }
 
-  // MarketData -> AlgoExecution -> Execution -> TradeBooking
-  marketdata_svc.AddListener(&algo_exec_svc);
-  AlgoExecToExecutionListener algoexec_to_exec(execution_svc);
-  algo_exec_svc.AddListener(&algoexec_to_exec);
+  // ---------- Tick-to-trade chain (statically wired) ----------
+  // MarketData -> AlgoExecution -> Execution -> TradeBooking -> Position -> Risk,
+  // with the persistence listeners as the tails of Execution, Position and Risk.
+  using PositionPersist = FanoutListener<Position<Bond>, PersistToHistoricalListener<Position<Bond>>,
+                                         BucketedPositionPersistListener>;
+  using RiskPersist = FanoutListener<PV01<Bond>, PersistToHistoricalListener<PV01<Bond>>, BucketedRiskPersistListener>;
+  PositionPersist persist_positions(persist_pos, persist_bpos);
+  RiskPersist persist_risks(persist_risk, persist_brisk);
+
+  BondStaticPipeline<PersistToHistoricalListener<ExecutionOrder<Bond>>, PositionPersist, RiskPersist> pipeline(
+      persist_exec, persist_positions, persist_risks, alternation);
+  auto& marketdata_svc = pipeline.marketdata;
+  auto& tradebooking_svc = pipeline.tradebooking;
+
+  // ---------- Other services (dynamically wired) ----------
+  BondPricingService pricing_svc;
+  BondAlgoStreamingService algo_stream_svc(alternation);
+  BondStreamingService streaming_svc;
 
-  ExecutionToTradeBookingListener exec_to_tb(tradebooking_svc);
-  execution_svc.AddListener(&exec_to_tb);
+  BondInquiryService inquiry_svc;
 
   // Pricing -> AlgoStreaming -> Streaming
   pricing_svc.AddListener(&algo_stream_svc);
-  AlgoStreamToStreamingListener algostream_to_stream(streaming_svc);
+  AlgoStreamToStreamingListener<> algostream_to_stream(streaming_svc);
   algo_stream_svc.AddListener(&algostream_to_stream);
 
   // Pricing -> GUI
@@ -238,52 +361,26 @@ int main() {
   InquiryQuoteLoopbackConnector<BondInquiryService, Bond> inq_loopback(inquiry_svc);
   inquiry_svc.SetConnector(&inq_loopback);
 
-  // ---------- Historical persistence ----------
-  BondHistoricalPositionService hist_pos("positions.txt");
-  BondHistoricalBucketedPositionService hist_bpos("positions_bucketed.txt");
-  BondHistoricalRiskService hist_risk("risk.txt");
-  BondHistoricalBucketedRiskService hist_brisk("risk_bucketed.txt");
-  BondHistoricalExecutionService hist_exec("executions.txt");
-  BondHistoricalStreamingService hist_stream("streaming.txt");
-  BondHistoricalInquiryService hist_inq("allinquiries.txt");
-
-  PersistToHistoricalListener<Position<Bond>> persist_pos(hist_pos);
-  PersistToHistoricalListener<PV01<Bond>> persist_risk(hist_risk);
-  PersistToHistoricalListener<ExecutionOrder<Bond>> persist_exec(hist_exec);
-  PersistToHistoricalListener<PriceStream<Bond>> persist_stream(hist_stream);
-  PersistToHistoricalListener<Inquiry<Bond>> persist_inq(hist_inq);
-
-  BucketedPositionPersistListener persist_bpos(hist_bpos);
-  BucketedRiskPersistListener persist_brisk(hist_brisk);
-
-  position_svc.AddListener(&persist_pos);
-  position_svc.AddListener(&persist_bpos);
-  risk_svc.AddListener(&persist_risk);
-  risk_svc.AddListener(&persist_brisk);
-  execution_svc.AddListener(&persist_exec);
   streaming_svc.AddListener(&persist_stream);
+  pipeline.execution.SetPublishConnector(&exec_out);
+  streaming_svc.SetPublishConnector(&stream_out);
   inquiry_svc.AddListener(&persist_inq);
 
-  // ---------- Inbound connectors ----------
-  BondMarketDataShmSubscriber<BondMarketDataService> md_in(marketdata_svc, "BOND_MD_SHM");
-  auto px_in = MakePricingInbound(pricing_svc, 9001);
-  auto tr_in = MakeTradesInbound(tradebooking_svc, 9002);
-  auto iq_in = MakeInquiriesInbound(inquiry_svc, 9003);
-
-  // ---------- Run inbound feeds (threads) ----------
-  std::thread t_md([&] { md_in.Subscribe(); });
-  std::thread t_px([&] { px_in.Subscribe(); });
-  std::thread t_tr([&] { tr_in.Subscribe(); });
-  std::thread t_iq([&] { iq_in.Subscribe(); });
-
-  std::cout << "Trading system running.\n"
-            << "Ports: prices=9001 trades=9002 inquiries=9003\n"
-            << "Outbound: executions=9101 streaming=9102\n"
-            << "Market data SHM name: BOND_MD_SHM\n";
+  // ---------- Inbound feeds ----------
+  if (mode == "direct") {
+    RunInboundFeeds(signals, release_outbound, marketdata_svc, pricing_svc, tradebooking_svc, inquiry_svc);
+    print_latency();
+    return 0;
+  }
 
-  t_md.join();
-  t_px.join();
-  t_tr.join();
-  t_iq.join();
+  BondSequencer<decltype(pipeline)::MarketDataSvc, BondPricingService, decltype(pipeline)::TradeBookingSvc,
+                BondInquiryService>
+      sequencer(marketdata_svc, pricing_svc, tradebooking_svc, inquiry_svc, priority);
+  std::thread t_seq([&] { sequencer.Run(); });
+  RunInboundFeeds(signals, release_outbound, sequencer.MarketDataInbound(), sequencer.PricingInbound(),
+                  sequencer.TradesInbound(), sequencer.InquiriesInbound());
+  sequencer.Stop();
+  t_seq.join();
+  print_latency();
   return 0;
 }
@@ -7,15 +7,25 @@
 #ifndef MARKET_DATA_SERVICE_HPP
 #define MARKET_DATA_SERVICE_HPP
 
+#include <array>
+#include <cstddef>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "soa.hpp"
+#include "PriceTicks.hpp"
 
 using namespace std;
 
 // Side for market data
 enum PricingSide { BID, OFFER };
 
+// Incremental book update actions, applied at a level index on one side
+enum BookAction { BOOK_ADD, BOOK_MODIFY, BOOK_DELETE };
+
+// "No level" in a BookChange, and the result of a rejected update
+constexpr size_t kNoBookLevel = static_cast<size_t>(-1);
+
 /**
  * A market data order with price, quantity, and side.
  */
@@ -25,10 +35,13 @@ class Order
 public:
 
   // ctor for an order
-  Order(double _price, long _quantity, PricingSide _side);
+  Order(PriceTicks _price, long _quantity, PricingSide _side);
+
+  // empty order (zero price and quantity), for fixed-size level arrays
+  Order();
 
   // Get the price on the order
-  double GetPrice() const;
+  PriceTicks GetPrice() const;
 
   // Get the quantity on the order
   long GetQuantity() const;
@@ -37,7 +50,7 @@ public:
   PricingSide GetSide() const;
 
 private:
-  double price;
+  PriceTicks price;
   long quantity;
   PricingSide side;
 
@@ -66,32 +79,314 @@ private:
 
 };
 
+/**
+ * One side of an order book: up to Depth levels, best first, stored inline
+ * (no heap). Has the vector-style members the book's readers use.
+ */
+template<size_t Depth>
+class OrderStack
+{
+
+public:
+
+  static constexpr size_t kDepth = Depth;
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == Depth; }
+  static constexpr size_t capacity() { return Depth; }
+
+  const Order& operator[](size_t i) const { return levels[i]; }
+  const Order& front() const { return levels[0]; }
+  const Order& back() const { return levels[count - 1]; }
+  const Order* begin() const { return levels.data(); }
+  const Order* end() const { return levels.data() + count; }
+
+  void clear() { count = 0; }
+
+  // Keep only the first n levels (no-op if n >= size).
+  void truncate(size_t n) { if (n < count) count = n; }
+
+  // Throws std::length_error if the stack already holds Depth levels.
+  void push_back(const Order &order)
+  {
+    if (full()) throw std::length_error("OrderStack: more than " + std::to_string(Depth) + " levels");
+    levels[count++] = order;
+  }
+
+  // Insert at pos (<= size), shifting deeper levels down. A full stack drops its
+  // last level to make room. Returns false if pos is past the end or the depth.
+  bool insert(size_t pos, const Order &order)
+  {
+    if (pos > count || pos >= Depth) return false;
+    const size_t last = full() ? Depth - 1 : count++;
+    for (size_t i = last; i > pos; --i) levels[i] = levels[i - 1];
+    levels[pos] = order;
+    return true;
+  }
+
+  // Replace the level at pos. Returns false if there is no such level.
+  bool replace(size_t pos, const Order &order)
+  {
+    if (pos >= count) return false;
+    levels[pos] = order;
+    return true;
+  }
+
+  // Remove the level at pos, shifting deeper levels up. Returns false if there is no such level.
+  bool erase(size_t pos)
+  {
+    if (pos >= count) return false;
+    for (size_t i = pos + 1; i < count; ++i) levels[i - 1] = levels[i];
+    --count;
+    return true;
+  }
+
+private:
+  array<Order, Depth> levels;
+  size_t count = 0;
+
+};
+
+// Levels per side of an OrderBook unless a feed asks for another depth
+// (marketdata.txt carries 5). OrderBook<Bond>, and so the market data service and
+// the SHM decoder, use this; deeper books on the feed are counted and skipped.
+constexpr size_t kDefaultBookDepth = 5;
+
+/**
+ * One incremental change to one side of a book, addressed by level index
+ * (0 = best), with the level's price and quantity:
+ *   BOOK_ADD    inserts a level at the index, pushing deeper levels down
+ *   BOOK_MODIFY replaces the level at the index
+ *   BOOK_DELETE removes the level at the index, pulling deeper levels up
+ */
+class LevelUpdate
+{
+
+public:
+
+  // ctor for a level update
+  LevelUpdate(BookAction _action, PricingSide _side, size_t _level, PriceTicks _price, long _quantity);
+
+  // empty update, for fixed-size update arrays
+  LevelUpdate();
+
+  // Get the action
+  BookAction GetAction() const;
+
+  // Get the side of the book
+  PricingSide GetSide() const;
+
+  // Get the level index
+  size_t GetLevel() const;
+
+  // Get the level price
+  PriceTicks GetPrice() const;
+
+  // Get the level quantity
+  long GetQuantity() const;
+
+private:
+  BookAction action;
+  PricingSide side;
+  size_t level;
+  PriceTicks price;
+  long quantity;
+
+};
+
+/**
+ * Which levels an update touched: the shallowest changed level on each side,
+ * or kNoBookLevel if that side is unchanged.
+ */
+struct BookChange
+{
+  size_t bidLevel = kNoBookLevel;
+  size_t offerLevel = kNoBookLevel;
+
+  // Whole book replaced (a snapshot)
+  static BookChange All() { return BookChange{0, 0}; }
+
+  bool Any() const { return bidLevel != kNoBookLevel || offerLevel != kNoBookLevel; }
+  bool TopChanged() const { return bidLevel == 0 || offerLevel == 0; }
+
+  void Touch(PricingSide side, size_t level)
+  {
+    size_t& l = (side == BID) ? bidLevel : offerLevel;
+    if (level < l) l = level;
+  }
+};
+
 /**
  * Order book with a bid and offer stack.
- * Type T is the product type.
+ * Type T is the product type; Depth is the maximum number of levels per side.
+ * The book is one flat object, so copying it is a memcpy.
  */
-template<typename T>
+template<typename T, size_t Depth = kDefaultBookDepth>
 class OrderBook
 {
 
 public:
 
+  using Stack = OrderStack<Depth>;
+
   // ctor for the order book
+  OrderBook(const T &_product, const Stack &_bidStack, const Stack &_offerStack);
+
+  // ctor from vectors; throws std::length_error if either is deeper than Depth
   OrderBook(const T &_product, const vector<Order> &_bidStack, const vector<Order> &_offerStack);
 
   // Get the product
   const T& GetProduct() const;
 
   // Get the bid stack
-  const vector<Order>& GetBidStack() const;
+  const Stack& GetBidStack() const;
 
   // Get the offer stack
-  const vector<Order>& GetOfferStack() const;
+  const Stack& GetOfferStack() const;
+
+  // Apply one incremental update in place. Returns the level it changed, or
+  // kNoBookLevel if the update does not fit the book (no such level, or past Depth).
+  size_t Apply(const LevelUpdate &update);
+
+  // Mutable side, for code that maintains a book in place
+  Stack& GetStack(PricingSide side);
 
 private:
-  T product;
-  vector<Order> bidStack;
-  vector<Order> offerStack;
+  const T* product;
+  Stack bidStack;
+  Stack offerStack;
+
+};
+
+/**
+ * A group of level updates for one product that together take its book from one
+ * consistent state to the next; listeners are notified once per group.
+ * Holds up to 4 * Depth updates, enough to turn any Depth-level book into any other.
+ */
+template<typename T, size_t Depth = kDefaultBookDepth>
+class OrderBookDelta
+{
+
+public:
+
+  static constexpr size_t kMaxUpdates = 4 * Depth;
+
+  // ctor for an empty delta
+  explicit OrderBookDelta(const T &_product);
+
+  // empty delta with no product yet, for decode scratch; Reset before use
+  OrderBookDelta();
+
+  // Get the product
+  const T& GetProduct() const;
+
+  // Start a new, empty group for a product
+  void Reset(const T &_product);
+
+  // Add an update; throws std::length_error past kMaxUpdates
+  void Add(const LevelUpdate &update);
+
+  size_t Size() const { return count; }
+  const LevelUpdate* begin() const { return updates.data(); }
+  const LevelUpdate* end() const { return updates.data() + count; }
+
+  // Apply every update to book in order; returns what changed
+  BookChange ApplyTo(OrderBook<T, Depth> &book) const;
+
+  // As above, but stops at the first update the book rejects and sets rejected:
+  // the book then no longer matches the sender's
+  BookChange ApplyTo(OrderBook<T, Depth> &book, bool &rejected) const;
+
+private:
+  const T* product;
+  array<LevelUpdate, kMaxUpdates> updates;
+  size_t count = 0;
+
+};
+
+// Fill delta with the updates that turn book from into book to (same product).
+// Levels are compared position by position: a changed level is a BOOK_MODIFY,
+// extra levels in to are BOOK_ADDs and missing ones BOOK_DELETEs (deepest first).
+template<typename T, size_t Depth>
+void DiffOrderBooks(const OrderBook<T, Depth> &from, const OrderBook<T, Depth> &to, OrderBookDelta<T, Depth> &delta)
+{
+  delta.Reset(to.GetProduct());
+  auto diff_side = [&](const OrderStack<Depth> &a, const OrderStack<Depth> &b, PricingSide side) {
+    const size_t common = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < common; ++i)
+    {
+      if (a[i].GetPrice() != b[i].GetPrice() || a[i].GetQuantity() != b[i].GetQuantity())
+        delta.Add(LevelUpdate(BOOK_MODIFY, side, i, b[i].GetPrice(), b[i].GetQuantity()));
+    }
+    for (size_t i = a.size(); i > common; --i)
+      delta.Add(LevelUpdate(BOOK_DELETE, side, i - 1, a[i - 1].GetPrice(), a[i - 1].GetQuantity()));
+    for (size_t i = common; i < b.size(); ++i)
+      delta.Add(LevelUpdate(BOOK_ADD, side, i, b[i].GetPrice(), b[i].GetQuantity()));
+  };
+  diff_side(from.GetBidStack(), to.GetBidStack(), BID);
+  diff_side(from.GetOfferStack(), to.GetOfferStack(), OFFER);
+}
+
+/**
+ * A book with equal prices merged into one level per price, plus the cumulative
+ * quantity down to each level and how many raw levels (orders) each one merges.
+ * Kept in step with a raw book by Update(raw, change): only the levels from the
+ * first changed price down are rebuilt. Every accessor is O(1).
+ */
+template<typename T, size_t Depth = kDefaultBookDepth>
+class AggregatedOrderBook
+{
+
+public:
+
+  // ctor: aggregate raw in full
+  explicit AggregatedOrderBook(const OrderBook<T, Depth> &raw);
+
+  // Bring the aggregate in line with raw after the levels in change were modified
+  void Update(const OrderBook<T, Depth> &raw, const BookChange &change);
+
+  // Get the aggregated book (one level per price, best first)
+  const OrderBook<T, Depth>& GetBook() const;
+
+  // Total quantity on levels 0..level of a side
+  long GetCumulativeQuantity(PricingSide side, size_t level) const;
+
+  // Number of raw levels merged into an aggregated level
+  size_t GetOrderCount(PricingSide side, size_t level) const;
+
+private:
+  struct Ladder
+  {
+    array<long, Depth> cumulative{};   // by aggregated level
+    array<size_t, Depth> orders{};     // by aggregated level
+    array<size_t, Depth> firstRaw{};   // first raw level of each aggregated level
+    array<size_t, Depth> aggOfRaw{};   // aggregated level of each raw level
+  };
+
+  void UpdateSide(PricingSide side, const OrderStack<Depth> &raw, size_t fromRawLevel);
+
+  const Ladder& GetLadder(PricingSide side) const { return side == BID ? bidLadder : offerLadder; }
+
+  OrderBook<T, Depth> book;
+  Ladder bidLadder;
+  Ladder offerLadder;
+
+};
+
+/**
+ * Order book listener that also wants to know what an incremental update changed,
+ * e.g. to skip work when the top of book did not move. Services that apply deltas
+ * call ProcessChange for these listeners and ProcessUpdate for plain ones; snapshots
+ * still arrive through ProcessUpdate.
+ */
+template<typename T>
+class OrderBookListener : public ServiceListener<OrderBook<T>>
+{
+
+public:
+
+  virtual void ProcessChange(OrderBook<T> &book, const BookChange &change) = 0;
 
 };
 
@@ -112,16 +407,19 @@ public:
   // Aggregate the order book
   virtual const OrderBook<T>& AggregateDepth(const string &productId) = 0;
 
+  // Apply an incremental update to a stored book
+  virtual void OnDelta(OrderBookDelta<T> &delta) = 0;
+
 };
 
-Order::Order(double _price, long _quantity, PricingSide _side)
+Order::Order(PriceTicks _price, long _quantity, PricingSide _side)
 {
   price = _price;
   quantity = _quantity;
   side = _side;
 }
 
-double Order::GetPrice() const
+PriceTicks Order::GetPrice() const
 {
   return price;
 }
@@ -136,6 +434,44 @@ PricingSide Order::GetSide() const
   return side;
 }
 
+Order::Order() : price(), quantity(0), side(BID)
+{
+}
+
+LevelUpdate::LevelUpdate(BookAction _action, PricingSide _side, size_t _level, PriceTicks _price, long _quantity) :
+  action(_action), side(_side), level(_level), price(_price), quantity(_quantity)
+{
+}
+
+LevelUpdate::LevelUpdate() : action(BOOK_MODIFY), side(BID), level(0), price(), quantity(0)
+{
+}
+
+BookAction LevelUpdate::GetAction() const
+{
+  return action;
+}
+
+PricingSide LevelUpdate::GetSide() const
+{
+  return side;
+}
+
+size_t LevelUpdate::GetLevel() const
+{
+  return level;
+}
+
+PriceTicks LevelUpdate::GetPrice() const
+{
+  return price;
+}
+
+long LevelUpdate::GetQuantity() const
+{
+  return quantity;
+}
+
 BidOffer::BidOffer(const Order &_bidOrder, const Order &_offerOrder) :
   bidOrder(_bidOrder), offerOrder(_offerOrder)
 {
@@ -151,28 +487,191 @@ const Order& BidOffer::GetOfferOrder() const
   return offerOrder;
 }
 
-template<typename T>
-OrderBook<T>::OrderBook(const T &_product, const vector<Order> &_bidStack, const vector<Order> &_offerStack) :
-  product(_product), bidStack(_bidStack), offerStack(_offerStack)
+template<typename T, size_t Depth>
+OrderBook<T, Depth>::OrderBook(const T &_product, const Stack &_bidStack, const Stack &_offerStack) :
+  product(&_product), bidStack(_bidStack), offerStack(_offerStack)
 {
 }
 
-template<typename T>
-const T& OrderBook<T>::GetProduct() const
+template<typename T, size_t Depth>
+OrderBook<T, Depth>::OrderBook(const T &_product, const vector<Order> &_bidStack, const vector<Order> &_offerStack) :
+  product(&_product)
 {
-  return product;
+  for (const Order& o : _bidStack) bidStack.push_back(o);
+  for (const Order& o : _offerStack) offerStack.push_back(o);
 }
 
-template<typename T>
-const vector<Order>& OrderBook<T>::GetBidStack() const
+template<typename T, size_t Depth>
+const T& OrderBook<T, Depth>::GetProduct() const
+{
+  return *product;
+}
+
+template<typename T, size_t Depth>
+const typename OrderBook<T, Depth>::Stack& OrderBook<T, Depth>::GetBidStack() const
 {
   return bidStack;
 }
 
-template<typename T>
-const vector<Order>& OrderBook<T>::GetOfferStack() const
+template<typename T, size_t Depth>
+const typename OrderBook<T, Depth>::Stack& OrderBook<T, Depth>::GetOfferStack() const
 {
   return offerStack;
 }
 
+template<typename T, size_t Depth>
+size_t OrderBook<T, Depth>::Apply(const LevelUpdate &update)
+{
+  Stack& stack = (update.GetSide() == BID) ? bidStack : offerStack;
+  const Order order(update.GetPrice(), update.GetQuantity(), update.GetSide());
+  bool ok = false;
+  switch (update.GetAction())
+  {
+    case BOOK_ADD: ok = stack.insert(update.GetLevel(), order); break;
+    case BOOK_MODIFY: ok = stack.replace(update.GetLevel(), order); break;
+    case BOOK_DELETE: ok = stack.erase(update.GetLevel()); break;
+  }
+  return ok ? update.GetLevel() : kNoBookLevel;
+}
+
+template<typename T, size_t Depth>
+typename OrderBook<T, Depth>::Stack& OrderBook<T, Depth>::GetStack(PricingSide side)
+{
+  return side == BID ? bidStack : offerStack;
+}
+
+template<typename T, size_t Depth>
+AggregatedOrderBook<T, Depth>::AggregatedOrderBook(const OrderBook<T, Depth> &raw) :
+  book(raw.GetProduct(), OrderStack<Depth>(), OrderStack<Depth>())
+{
+  Update(raw, BookChange::All());
+}
+
+template<typename T, size_t Depth>
+void AggregatedOrderBook<T, Depth>::Update(const OrderBook<T, Depth> &raw, const BookChange &change)
+{
+  UpdateSide(BID, raw.GetBidStack(), change.bidLevel);
+  UpdateSide(OFFER, raw.GetOfferStack(), change.offerLevel);
+}
+
+template<typename T, size_t Depth>
+void AggregatedOrderBook<T, Depth>::UpdateSide(PricingSide side, const OrderStack<Depth> &raw, size_t fromRawLevel)
+{
+  if (fromRawLevel == kNoBookLevel) return;
+  Ladder& ladder = side == BID ? bidLadder : offerLadder;
+  OrderStack<Depth>& agg = book.GetStack(side);
+
+  // Raw levels above fromRawLevel are unchanged, and so is every aggregated level
+  // before the one holding the last of them (the next raw level may share its price).
+  size_t k = 0;
+  size_t start = 0;
+  if (fromRawLevel > 0 && fromRawLevel <= raw.size())
+  {
+    k = ladder.aggOfRaw[fromRawLevel - 1];
+    start = ladder.firstRaw[k];
+  }
+  agg.truncate(k);
+
+  for (size_t r = start; r < raw.size(); ++r)
+  {
+    const Order& o = raw[r];
+    if (agg.size() > k && agg.back().GetPrice() == o.GetPrice())
+    {
+      const size_t last = agg.size() - 1;
+      agg.replace(last, Order(o.GetPrice(), agg.back().GetQuantity() + o.GetQuantity(), side));
+      ladder.cumulative[last] += o.GetQuantity();
+      ++ladder.orders[last];
+    }
+    else
+    {
+      const size_t level = agg.size();
+      agg.push_back(Order(o.GetPrice(), o.GetQuantity(), side));
+      ladder.cumulative[level] = (level ? ladder.cumulative[level - 1] : 0) + o.GetQuantity();
+      ladder.orders[level] = 1;
+      ladder.firstRaw[level] = r;
+    }
+    ladder.aggOfRaw[r] = agg.size() - 1;
+  }
+}
+
+template<typename T, size_t Depth>
+const OrderBook<T, Depth>& AggregatedOrderBook<T, Depth>::GetBook() const
+{
+  return book;
+}
+
+template<typename T, size_t Depth>
+long AggregatedOrderBook<T, Depth>::GetCumulativeQuantity(PricingSide side, size_t level) const
+{
+  return GetLadder(side).cumulative[level];
+}
+
+template<typename T, size_t Depth>
+size_t AggregatedOrderBook<T, Depth>::GetOrderCount(PricingSide side, size_t level) const
+{
+  return GetLadder(side).orders[level];
+}
+
+template<typename T, size_t Depth>
+OrderBookDelta<T, Depth>::OrderBookDelta(const T &_product) :
+  product(&_product)
+{
+}
+
+template<typename T, size_t Depth>
+OrderBookDelta<T, Depth>::OrderBookDelta() :
+  product(nullptr)
+{
+}
+
+template<typename T, size_t Depth>
+const T& OrderBookDelta<T, Depth>::GetProduct() const
+{
+  return *product;
+}
+
+template<typename T, size_t Depth>
+void OrderBookDelta<T, Depth>::Reset(const T &_product)
+{
+  product = &_product;
+  count = 0;
+}
+
+template<typename T, size_t Depth>
+void OrderBookDelta<T, Depth>::Add(const LevelUpdate &update)
+{
+  if (count == kMaxUpdates) throw std::length_error("OrderBookDelta: more than " + std::to_string(kMaxUpdates) + " updates");
+  updates[count++] = update;
+}
+
+template<typename T, size_t Depth>
+BookChange OrderBookDelta<T, Depth>::ApplyTo(OrderBook<T, Depth> &book) const
+{
+  BookChange change;
+  for (const LevelUpdate& u : *this)
+  {
+    const size_t level = book.Apply(u);
+    if (level != kNoBookLevel) change.Touch(u.GetSide(), level);
+  }
+  return change;
+}
+
+template<typename T, size_t Depth>
+BookChange OrderBookDelta<T, Depth>::ApplyTo(OrderBook<T, Depth> &book, bool &rejected) const
+{
+  BookChange change;
+  rejected = false;
+  for (const LevelUpdate& u : *this)
+  {
+    const size_t level = book.Apply(u);
+    if (level == kNoBookLevel)
+    {
+      rejected = true;
+      break;
+    }
+    change.Touch(u.GetSide(), level);
+  }
+  return change;
+}
+
 #endif
@@ -1,19 +1,65 @@
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "MarketDataFileToShmPublisher.hpp"
 
 int main(int argc, char** argv) {
-  std::string file = "marketdata.txt";
+  // Usage: ./md_shm_publisher [file] [shm] [binary|text] [ring_kb] [spsc|broadcast] [snapshot_every]
+  //                           [replay flags, see FileReplay.hpp]
+  // ring_kb = 0 keeps the default size for the chosen ring.
+  // snapshot_every = 0 sends full snapshots only; otherwise binary books go out as
+  // deltas with a snapshot every N updates per product (default 100).
+  // Default is firehose; --rate=N paces to N books/sec, --timestamps replays the
+  // "<offset_us>\t" prefixes.
+  std::string file = "marketdata.txt";  // or gen_data --binary's marketdata.bin
   std::string shm  = "BOND_MD_SHM";
+  MdWireFormat format = kMdDefaultWireFormat;
+  std::size_t ring_bytes = 0;
+  bool broadcast = false;
+  std::size_t snapshot_every = kMdDefaultSnapshotEvery;
+  ReplayOptions replay;
   boost::interprocess::shared_memory_object::remove("BOND_MD_SHM");
 
-  if (argc > 1) file = argv[1];
-  if (argc > 2) shm  = argv[2];
+  std::vector<std::string> args;
+  try {
+    args = SplitReplayArgs(argc, argv, replay);
+    if (args.size() > 3) ring_bytes = static_cast<std::size_t>(std::stoul(args[3])) * 1024;
+    if (args.size() > 5) snapshot_every = static_cast<std::size_t>(std::stoul(args[5]));
+  } catch (const std::exception& e) {
+    std::cerr << "md_shm_publisher: " << e.what() << "\n"
+              << "Usage: md_shm_publisher [file] [shm] [binary|text] [ring_kb] [spsc|broadcast] [snapshot_every]\n"
+              << kReplayFlagsUsage << "\n";
+    return 1;
+  }
+
+  if (args.size() > 0) file = args[0];
+  if (args.size() > 1) shm  = args[1];
+  if (args.size() > 2) {
+    const std::string fmt = args[2];
+    if (fmt == "text") format = MdWireFormat::kText;
+    else if (fmt == "binary") format = MdWireFormat::kBinary;
+    else {
+      std::cerr << "md_shm_publisher: unknown format '" << fmt << "' (binary|text)\n";
+      return 1;
+    }
+  }
+  if (args.size() > 4) {
+    const std::string ring = args[4];
+    if (ring == "broadcast") broadcast = true;
+    else if (ring != "spsc") {
+      std::cerr << "md_shm_publisher: unknown ring '" << ring << "' (spsc|broadcast)\n";
+      return 1;
+    }
+  }
 
   try {
-    MarketDataFileToShmProcess(file, shm);
-    std::cout << "Published market data from " << file << " to SHM " << shm << "\n";
+    const ReplayStats stats = MarketDataFileToShmProcess(file, shm, format, ring_bytes, broadcast, snapshot_every, replay);
+    std::cout << "Published market data from " << file << " to SHM " << shm
+              << (format == MdWireFormat::kText ? " (text" : " (binary")
+              << (broadcast ? ", broadcast)" : ")") << ": ";
+    stats.Print(std::cout);
+    std::cout << "\n";
   } catch (const std::exception& e) {
     std::cerr << "md_shm_publisher error: " << e.what() << "\n";
     return 1;
@@ -0,0 +1,269 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BondSocketParsers.hpp"
+#include "BondUniverse.hpp"
+
+// Compares the inbound line parsers against the previous Split/stoi/stod path,
+// one feed at a time, on synthetic lines shaped like gen_data output.
+//   parse      : line -> decoded fields (what the parser layer itself costs)
+//   parse+build: line -> domain object, as the inbound connectors do
+// The target is 10x over the legacy path; a stage below it is flagged. Known gap:
+// trades and inquiries run at about 6-9x in parse+build (inquiries at 9-10x in
+// parse alone). Their lines are six short fields, so the legacy Split costs less
+// per line than for books, and what is left on the new path (a memchr per field,
+// from_chars, the product lookup and building the object's strings) does not
+// shrink further.
+//
+// Usage: ./parse_bench [lines_per_feed]
+
+namespace legacy {
+
+// The parsing code as it was before the string_view parsers, kept here as the baseline.
+// Each feed is split into the field-decoding step and the object it then built.
+
+inline PriceTicks ParsePriceTicks(const std::string& s) {
+  if (s.find('-') == std::string::npos) return PriceTicks::FromDouble(std::stod(s));
+  auto dash = s.find('-');
+  int whole = std::stoi(s.substr(0, dash));
+  std::string frac = s.substr(dash + 1);
+  if (frac.size() != 3) throw std::runtime_error("Bad fractional price: " + s);
+  int xy = std::stoi(frac.substr(0, 2));
+  char zc = frac[2];
+  int z = (zc == '+') ? 4 : zc - '0';
+  return PriceTicks::FromPoints(whole) + PriceTicks(xy * 8 + z);
+}
+
+struct PriceFields {
+  const Bond* bond;
+  PriceTicks mid, spread;
+};
+
+inline PriceFields ParsePriceFields(const std::string& line) {
+  auto f = Split(line, ',');
+  if (f.size() != 3) throw std::runtime_error("Bad price line: " + line);
+  return {&BondProductRepository::Instance().Get(f[0]), ParsePriceTicks(f[1]), ParsePriceTicks(f[2])};
+}
+
+struct TradeFields {
+  std::string trade_id;
+  const Bond* bond;
+  PriceTicks price;
+  std::string book;
+  long quantity;
+  Side side;
+};
+
+inline TradeFields ParseTradeFields(const std::string& line) {
+  auto f = Split(line, ',');
+  if (f.size() != 6) throw std::runtime_error("Bad trade line: " + line);
+  return {f[0], &BondProductRepository::Instance().Get(f[1]), ParsePriceTicks(f[2]), f[3], std::stol(f[4]),
+          (f[5] == "BUY") ? BUY : SELL};
+}
+
+struct InquiryFields {
+  std::string inquiry_id;
+  const Bond* bond;
+  Side side;
+  long quantity;
+  PriceTicks price;
+  InquiryState state;
+};
+
+inline InquiryFields ParseInquiryFields(const std::string& line) {
+  auto f = Split(line, ',');
+  if (f.size() != 6) throw std::runtime_error("Bad inquiry line: " + line);
+  InquiryState st = RECEIVED;
+  if (f[5] == "QUOTED") st = QUOTED;
+  else if (f[5] == "DONE") st = DONE;
+  return {f[0], &BondProductRepository::Instance().Get(f[1]), (f[2] == "BUY") ? BUY : SELL, std::stol(f[3]),
+          ParsePriceTicks(f[4]), st};
+}
+
+struct BookFields {
+  const Bond* bond;
+  std::vector<Order> bids, offers;
+};
+
+inline BookFields ParseBookFields(const std::string& line) {
+  auto parts = Split(line, '|');
+  if (parts.size() != 3) throw std::runtime_error("Bad orderbook line: " + line);
+  auto parse_stack = [&](const std::string& s, PricingSide side) {
+    std::vector<Order> out;
+    for (const auto& lvl : Split(s, ';')) {
+      if (lvl.empty()) continue;
+      auto pq = Split(lvl, ':');
+      if (pq.size() != 2) throw std::runtime_error("Bad level: " + lvl);
+      out.emplace_back(ParsePriceTicks(pq[0]), std::stol(pq[1]), side);
+    }
+    return out;
+  };
+  return {&BondProductRepository::Instance().Get(parts[0]), parse_stack(parts[1], BID), parse_stack(parts[2], OFFER)};
+}
+
+inline Price<Bond> ParsePriceLine(const std::string& line) {
+  PriceFields f = ParsePriceFields(line);
+  return Price<Bond>(*f.bond, f.mid, f.spread);
+}
+
+inline Trade<Bond> ParseTradeLine(const std::string& line) {
+  TradeFields f = ParseTradeFields(line);
+  return Trade<Bond>(*f.bond, f.trade_id, f.price, f.book, f.quantity, f.side);
+}
+
+inline Inquiry<Bond> ParseInquiryLine(const std::string& line) {
+  InquiryFields f = ParseInquiryFields(line);
+  return Inquiry<Bond>(f.inquiry_id, *f.bond, f.side, f.quantity, f.price, f.state);
+}
+
+inline OrderBook<Bond> ParseOrderBookLine(const std::string& line) {
+  BookFields f = ParseBookFields(line);
+  return OrderBook<Bond>(*f.bond, f.bids, f.offers);
+}
+
+}  // namespace legacy
+
+namespace {
+
+constexpr double kTargetSpeedup = 10.0;
+
+const char* kProducts[] = {"2Y", "3Y", "5Y", "7Y", "10Y", "20Y", "30Y"};
+
+std::string Px(long ticks) { return FormatPriceFractional(PriceTicks(99 * 256 + ticks % 512)); }
+
+std::vector<std::string> PriceLines(long n) {
+  std::vector<std::string> out;
+  for (long i = 0; i < n; ++i) out.push_back(std::string(kProducts[i % 7]) + "," + Px(i) + "," + (i % 2 ? "0-002" : "0-004"));
+  return out;
+}
+
+std::vector<std::string> TradeLines(long n) {
+  std::vector<std::string> out;
+  for (long i = 0; i < n; ++i)
+    out.push_back("T" + std::to_string(i) + "," + kProducts[i % 7] + "," + Px(i) + ",TRSY" + std::to_string(i % 3 + 1) +
+                  "," + std::to_string((i % 5 + 1) * 1000000) + "," + (i % 2 ? "SELL" : "BUY"));
+  return out;
+}
+
+std::vector<std::string> InquiryLines(long n) {
+  std::vector<std::string> out;
+  for (long i = 0; i < n; ++i)
+    out.push_back("I" + std::to_string(i) + "," + kProducts[i % 7] + "," + (i % 2 ? "SELL" : "BUY") + "," +
+                  std::to_string((i % 5 + 1) * 1000000) + "," + Px(i) + ",RECEIVED");
+  return out;
+}
+
+std::vector<std::string> BookLines(long n) {
+  std::vector<std::string> out;
+  for (long i = 0; i < n; ++i) {
+    std::string line = kProducts[i % 7];
+    for (int side = 0; side < 2; ++side) {
+      line += '|';
+      for (int lvl = 0; lvl < 5; ++lvl) {
+        if (lvl) line += ';';
+        line += Px(side ? i + 2 + lvl : i - lvl + 512) + ":" + std::to_string((lvl + 1) * 10000000);
+      }
+    }
+    out.push_back(line);
+  }
+  return out;
+}
+
+// Runs fn over every line and returns ns/line. fn returns a value folded into sink
+// so the work cannot be optimised away.
+template <typename Fn>
+double NsPerLine(const std::vector<std::string>& lines, std::int64_t& sink, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& line : lines) sink += fn(line);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(lines.size());
+}
+
+void Report(const char* feed, const char* stage, double legacy_ns, double fast_ns) {
+  std::cout << feed << ' ' << stage << "  legacy=" << legacy_ns << "ns/line  string_view=" << fast_ns
+            << "ns/line (" << static_cast<long long>(1e9 / fast_ns) << " lines/sec)  speedup=" << legacy_ns / fast_ns
+            << "x" << (legacy_ns / fast_ns < kTargetSpeedup ? "  (below the 10x target)" : "") << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  long n = 200000;
+  if (argc > 1) n = std::stol(argv[1]);
+
+  RegisterBondUniverse();
+  std::int64_t sink = 0;
+
+  {
+    const auto lines = PriceLines(n);
+    Report("prices   ", "parse      ",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParsePriceFields(l).mid.Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             PriceLineFields f;
+             return ParsePriceFields(l, f) == ParseStatus::kOk ? f.mid.Ticks() : 0;
+           }));
+    Report("prices   ", "parse+build",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParsePriceLine(l).GetMid().Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             std::optional<Price<Bond>> p;
+             return TryParsePriceLine(l, p) == ParseStatus::kOk ? p->GetMid().Ticks() : 0;
+           }));
+  }
+  {
+    const auto lines = TradeLines(n);
+    Report("trades   ", "parse      ",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParseTradeFields(l).price.Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             TradeLineFields f;
+             return ParseTradeFields(l, f) == ParseStatus::kOk ? f.price.Ticks() : 0;
+           }));
+    Report("trades   ", "parse+build",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParseTradeLine(l).GetPrice().Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             std::optional<Trade<Bond>> t;
+             return TryParseTradeLine(l, t) == ParseStatus::kOk ? t->GetPrice().Ticks() : 0;
+           }));
+  }
+  {
+    const auto lines = InquiryLines(n);
+    Report("inquiries", "parse      ",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParseInquiryFields(l).price.Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             InquiryLineFields f;
+             return ParseInquiryFields(l, f) == ParseStatus::kOk ? f.price.Ticks() : 0;
+           }));
+    Report("inquiries", "parse+build",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParseInquiryLine(l).GetPrice().Ticks(); }),
+           NsPerLine(lines, sink, [](const std::string& l) {
+             std::optional<Inquiry<Bond>> i;
+             return TryParseInquiryLine(l, i) == ParseStatus::kOk ? i->GetPrice().Ticks() : 0;
+           }));
+  }
+  {
+    const auto lines = BookLines(n);
+    // Same as MdShmBookDecoder: parse into reused stacks.
+    const Bond* bond = nullptr;
+    OrderBook<Bond>::Stack bids, offers;
+    Report("books    ", "parse      ",
+           NsPerLine(lines, sink, [](const std::string& l) { return legacy::ParseBookFields(l).bids.front().GetPrice().Ticks(); }),
+           NsPerLine(lines, sink, [&](const std::string& l) {
+             return TryParseOrderBookLine(l, bond, bids, offers) == ParseStatus::kOk ? bids.front().GetPrice().Ticks() : 0;
+           }));
+    Report("books    ", "parse+build",
+           NsPerLine(lines, sink, [](const std::string& l) {
+             return legacy::ParseOrderBookLine(l).GetBidStack().front().GetPrice().Ticks();
+           }),
+           NsPerLine(lines, sink, [&](const std::string& l) {
+             if (TryParseOrderBookLine(l, bond, bids, offers) != ParseStatus::kOk) return std::int64_t{0};
+             return OrderBook<Bond>(*bond, bids, offers).GetBidStack().front().GetPrice().Ticks();
+           }));
+  }
+
+  std::cout << "(checksum " << sink << ")\n";
+  return 0;
+}
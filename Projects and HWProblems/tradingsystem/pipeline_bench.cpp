@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BondAlgoExecutionService.hpp"
+#include "BondExecutionService.hpp"
+#include "BondMarketDataService.hpp"
+#include "BondPositionService.hpp"
+#include "BondRiskService.hpp"
+#include "BondServiceBridges.hpp"
+#include "BondStaticPipeline.hpp"
+#include "BondTradeBookingService.hpp"
+#include "BondUniverse.hpp"
+
+// Compares the tick-to-trade chain wired two ways:
+//   dynamic: services registered with AddListener, a virtual call at every hop (as
+//            main.cpp did before BondStaticPipeline)
+//   static : BondStaticPipeline, every hop a direct call the compiler can inline
+// Each book has a 2-tick spread, so every tick goes all the way through
+// MarketData -> AlgoExecution -> Execution -> TradeBooking -> Position -> Risk.
+// The tails only count what reaches them.
+//
+// Usage: ./pipeline_bench [ticks] [rounds]
+
+namespace {
+
+const char* kProducts[] = {"2Y", "3Y", "5Y", "7Y", "10Y", "20Y", "30Y"};
+
+template <typename V>
+class CountingListener final : public ServiceListener<V> {
+ public:
+  void ProcessAdd(V&) override { ++count; }
+  void ProcessRemove(V&) override {}
+  void ProcessUpdate(V&) override { ++count; }
+
+  std::int64_t count = 0;
+};
+
+struct Tails {
+  CountingListener<ExecutionOrder<Bond>> executions;
+  CountingListener<Position<Bond>> positions;
+  CountingListener<PV01<Bond>> risks;
+
+  std::int64_t Sum() const { return executions.count + positions.count + risks.count; }
+};
+
+std::vector<OrderBook<Bond>> Books(long n) {
+  auto& repo = BondProductRepository::Instance();
+  std::vector<OrderBook<Bond>> out;
+  out.reserve(static_cast<std::size_t>(n));
+  for (long i = 0; i < n; ++i) {
+    const PriceTicks mid = PriceTicks::FromPoints(99) + PriceTicks(i % 256);
+    OrderBook<Bond>::Stack bids, offers;
+    for (int lvl = 0; lvl < 5; ++lvl) {
+      bids.push_back(Order(mid - PriceTicks(1 + lvl), (lvl + 1) * 10000000L, BID));
+      offers.push_back(Order(mid + PriceTicks(1 + lvl), (lvl + 1) * 10000000L, OFFER));
+    }
+    out.emplace_back(repo.Get(kProducts[i % 7]), bids, offers);
+  }
+  return out;
+}
+
+template <typename MarketData>
+double NsPerTick(MarketData& md, std::vector<OrderBook<Bond>>& books) {
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& book : books) md.OnMessage(book);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(books.size());
+}
+
+double RunDynamic(std::vector<OrderBook<Bond>>& books, Tails& tails) {
+  BondMarketDataService marketdata;
+  BondAlgoExecutionService algo_execution;
+  BondExecutionService execution;
+  BondTradeBookingService tradebooking;
+  BondPositionService position;
+  BondRiskService risk;
+
+  TradeToPositionListener<> trade_to_position(position);
+  PositionToRiskListener<> position_to_risk(risk);
+  AlgoExecToExecutionListener<> algo_to_execution(execution);
+  ExecutionToTradeBookingListener<> execution_to_tradebooking(tradebooking);
+
+  marketdata.AddListener(&algo_execution);
+  algo_execution.AddListener(&algo_to_execution);
+  execution.AddListener(&execution_to_tradebooking);
+  execution.AddListener(&tails.executions);
+  tradebooking.AddListener(&trade_to_position);
+  position.AddListener(&position_to_risk);
+  position.AddListener(&tails.positions);
+  risk.AddListener(&tails.risks);
+
+  return NsPerTick(marketdata, books);
+}
+
+double RunStatic(std::vector<OrderBook<Bond>>& books, Tails& tails) {
+  BondStaticPipeline<CountingListener<ExecutionOrder<Bond>>, CountingListener<Position<Bond>>,
+                     CountingListener<PV01<Bond>>>
+      pipeline(tails.executions, tails.positions, tails.risks);
+  return NsPerTick(pipeline.marketdata, books);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  long n = 200000;
+  int rounds = 5;
+  if (argc > 1) n = std::stol(argv[1]);
+  if (argc > 2) rounds = std::stoi(argv[2]);
+
+  RegisterBondUniverse();
+  auto books = Books(n);
+
+  // Alternate the two so neither always runs on a warmer cache; keep the best round.
+  double dynamic_ns = 0, static_ns = 0;
+  std::int64_t dynamic_out = 0, static_out = 0;
+  for (int r = 0; r < rounds; ++r) {
+    Tails d, s;
+    const double dn = RunDynamic(books, d);
+    const double sn = RunStatic(books, s);
+    if (r == 0 || dn < dynamic_ns) dynamic_ns = dn;
+    if (r == 0 || sn < static_ns) static_ns = sn;
+    dynamic_out = d.Sum();
+    static_out = s.Sum();
+  }
+
+  std::cout << "ticks=" << n << " rounds=" << rounds << " (best round)\n"
+            << "dynamic  " << dynamic_ns << " ns/tick\n"
+            << "static   " << static_ns << " ns/tick  speedup=" << dynamic_ns / static_ns << "x\n"
+            << "(tail events dynamic=" << dynamic_out << " static=" << static_out << ")\n";
+  return dynamic_out == static_out ? 0 : 1;
+}
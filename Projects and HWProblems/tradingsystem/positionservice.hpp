@@ -46,7 +46,7 @@ public:
   long GetAggregatePosition() const;
 
 private:
-  T product;
+  const T* product;
   map<string,long> positions;
 
 };
@@ -69,14 +69,14 @@ public:
 
 template<typename T>
 Position<T>::Position(const T &_product) :
-  product(_product)
+  product(&_product)
 {
 }
 
 template<typename T>
 const T& Position<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -3,20 +3,27 @@
 #include "ExternalFileToSocketPublishers.hpp"
 
 int main(int argc, char** argv) {
-  // Usage: ./prices_publisher [file] [host] [port]
+  // Usage: ./prices_publisher [file] [host] [port] [replay flags, see FileReplay.hpp]
+  // Default is firehose; --rate=N paces to N msgs/sec, --timestamps replays the
+  // "<offset_us>\t" prefixes.
   std::string file = "prices.txt";
   std::string host = "127.0.0.1";
   int port = 9001;
-
-  if (argc > 1) file = argv[1];
-  if (argc > 2) host = argv[2];
-  if (argc > 3) port = std::stoi(argv[3]);
+  ReplayOptions replay;
 
   try {
-    PricesFileProcess(file, host, port);
+    const auto args = SplitReplayArgs(argc, argv, replay);
+    if (args.size() > 0) file = args[0];
+    if (args.size() > 1) host = args[1];
+    if (args.size() > 2) port = std::stoi(args[2]);
+
+    const ReplayStats stats = PricesFileProcess(file, host, port, replay);
+    stats.Print(std::cerr << "[prices_publisher] ");
+    std::cerr << "\n";
   } catch (const std::exception& e) {
-    std::cerr << "prices_publisher error: " << e.what() << "\n";
+    std::cerr << "prices_publisher error: " << e.what() << "\n"
+              << "Usage: " << argv[0] << " [file] [host] [port] " << kReplayFlagsUsage << "\n";
     return 1;
   }
   return 0;
-}
\ No newline at end of file
+}
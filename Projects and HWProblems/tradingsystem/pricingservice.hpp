@@ -9,6 +9,7 @@
 
 #include <string>
 #include "soa.hpp"
+#include "PriceTicks.hpp"
 
 /**
  * A price object consisting of mid and bid/offer spread.
@@ -21,21 +22,21 @@ class Price
 public:
 
   // ctor for a price
-  Price(const T &_product, double _mid, double _bidOfferSpread);
+  Price(const T &_product, PriceTicks _mid, PriceTicks _bidOfferSpread);
 
   // Get the product
   const T& GetProduct() const;
 
   // Get the mid price
-  double GetMid() const;
+  PriceTicks GetMid() const;
 
   // Get the bid/offer spread around the mid
-  double GetBidOfferSpread() const;
+  PriceTicks GetBidOfferSpread() const;
 
 private:
-  const T& product;
-  double mid;
-  double bidOfferSpread;
+  const T* product;
+  PriceTicks mid;
+  PriceTicks bidOfferSpread;
 
 };
 
@@ -50,8 +51,8 @@ class PricingService : public Service<string,Price <T> >
 };
 
 template<typename T>
-Price<T>::Price(const T &_product, double _mid, double _bidOfferSpread) :
-  product(_product)
+Price<T>::Price(const T &_product, PriceTicks _mid, PriceTicks _bidOfferSpread) :
+  product(&_product)
 {
   mid = _mid;
   bidOfferSpread = _bidOfferSpread;
@@ -60,17 +61,17 @@ Price<T>::Price(const T &_product, double _mid, double _bidOfferSpread) :
 template<typename T>
 const T& Price<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
-double Price<T>::GetMid() const
+PriceTicks Price<T>::GetMid() const
 {
   return mid;
 }
 
 template<typename T>
-double Price<T>::GetBidOfferSpread() const
+PriceTicks Price<T>::GetBidOfferSpread() const
 {
   return bidOfferSpread;
 }
@@ -62,6 +62,9 @@ private:
 
 enum BondIdType { CUSIP, ISIN };
 
+// Bond::GetProductIndex() for a bond that BondProductRepository never registered
+const size_t kNoProductIndex = static_cast<size_t>(-1);
+
 /**
  * Bond product class
  */
@@ -86,6 +89,10 @@ public:
   // Get the bond identifier type
   BondIdType GetBondIdType() const;
 
+  // Dense index assigned by BondProductRepository; copies of the bond keep it
+  size_t GetProductIndex() const;
+  void SetProductIndex(size_t index);
+
   // Print the bond
   friend ostream& operator<<(ostream &output, const Bond &bond);
 
@@ -95,6 +102,7 @@ private:
   string ticker;
   float coupon;
   date maturityDate;
+  size_t productIndex = kNoProductIndex;
 
 };
 
@@ -207,6 +215,16 @@ Bond::Bond() : Product(0, BOND)
 {
 }
 
+size_t Bond::GetProductIndex() const
+{
+  return productIndex;
+}
+
+void Bond::SetProductIndex(size_t index)
+{
+  productIndex = index;
+}
+
 const string& Bond::GetTicker() const
 {
   return ticker;
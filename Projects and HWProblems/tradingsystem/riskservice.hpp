@@ -27,10 +27,10 @@ class PV01
 public:
   // ctor for a PV01 value
   PV01(const T &_product, double _pv01, long _quantity)
-      : product(_product), pv01(_pv01), quantity(_quantity) {}
+      : product(&_product), pv01(_pv01), quantity(_quantity) {}
 
   // Get the product on this PV01 value
-  const T& GetProduct() const { return product; }
+  const T& GetProduct() const { return *product; }
 
   // Get the PV01 value (typically PV01-per-unit; interpretation is up to service)
   double GetPV01() const { return pv01; }
@@ -39,30 +39,30 @@ public:
   long GetQuantity() const { return quantity; }
 
 private:
-  T product;
+  const T* product;
   double pv01;
   long quantity;
 };
 
 /**
  * A bucket sector to bucket a group of securities.
- * Type T is the product type.
+ * Type T is the product type. The sector refers to its products; it does not own them.
  */
 template<typename T>
 class BucketedSector
 {
 public:
-  BucketedSector(const vector<T> &_products, const string &_name)
+  BucketedSector(const vector<const T*> &_products, const string &_name)
       : products(_products), name(_name) {}
 
   // Get the products in this bucket
-  const vector<T>& GetProducts() const { return products; }
+  const vector<const T*>& GetProducts() const { return products; }
 
   // Get the name of the bucket
   const string& GetName() const { return name; }
 
 private:
-  vector<T> products;
+  vector<const T*> products;
   string name;
 };
 
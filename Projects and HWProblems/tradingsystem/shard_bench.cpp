@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BondShardedPipeline.hpp"
+#include "BondSocketParsers.hpp"
+#include "BondUniverse.hpp"
+
+// Throughput of BondShardedPipeline by shard count on gen_data output. The books and
+// prices are parsed up front, interleaved across products (gen_data --by_product
+// writes one product after another; a live feed would not), and pushed from one thread, as the
+// inbound feeds do. The merge stage only counts what it receives, so file I/O is not
+// part of the measurement.
+//
+// Usage: ./shard_bench [marketdata.txt] [prices.txt] [max_shards] [rounds]
+
+namespace {
+
+template <typename V>
+class CountingListener final : public ServiceListener<V> {
+ public:
+  void ProcessAdd(V&) override { ++count; }
+  void ProcessRemove(V&) override {}
+  void ProcessUpdate(V&) override { ++count; }
+
+  std::int64_t count = 0;
+};
+
+// Round-robin across products, keeping each product's own order.
+template <typename V>
+std::vector<V> Interleave(std::vector<std::vector<V>>& by_product) {
+  std::vector<V> out;
+  for (std::size_t i = 0;; ++i) {
+    bool any = false;
+    for (auto& v : by_product) {
+      if (i < v.size()) {
+        out.push_back(v[i]);
+        any = true;
+      }
+    }
+    if (!any) return out;
+  }
+}
+
+std::vector<OrderBook<Bond>> LoadBooks(const std::string& file) {
+  std::ifstream in(file);
+  if (!in) throw std::runtime_error("Unable to open " + file);
+  std::vector<std::vector<OrderBook<Bond>>> by_product(BondProductRepository::Instance().Size());
+  const Bond* bond = nullptr;
+  OrderBook<Bond>::Stack bids, offers;
+  for (std::string line; std::getline(in, line);) {
+    if (TryParseOrderBookLine(line, bond, bids, offers) != ParseStatus::kOk) continue;
+    by_product[ProductIndexOf(*bond)].emplace_back(*bond, bids, offers);
+  }
+  return Interleave(by_product);
+}
+
+std::vector<Price<Bond>> LoadPrices(const std::string& file) {
+  std::ifstream in(file);
+  if (!in) throw std::runtime_error("Unable to open " + file);
+  std::vector<std::vector<Price<Bond>>> by_product(BondProductRepository::Instance().Size());
+  for (std::string line; std::getline(in, line);) {
+    std::optional<Price<Bond>> p;
+    if (TryParsePriceLine(line, p) != ParseStatus::kOk) continue;
+    by_product[ProductIndexOf(p->GetProduct())].push_back(*p);
+  }
+  return Interleave(by_product);
+}
+
+// Messages/sec through `shards` shards, from the first push until every shard has
+// handled everything and the merge stage has drained.
+double Run(std::size_t shards, std::vector<OrderBook<Bond>>& books, std::vector<Price<Bond>>& prices,
+           std::int64_t& merged) {
+  BondShardedPipeline pipeline(shards);
+  CountingListener<ExecutionOrder<Bond>> executions;
+  CountingListener<Position<Bond>> positions;
+  CountingListener<PV01<Bond>> risk;
+  CountingListener<PriceStream<Bond>> streams;
+  pipeline.Merge().executions.AddListener(&executions);
+  pipeline.Merge().positions.AddListener(&positions);
+  pipeline.Merge().risk.AddListener(&risk);
+  pipeline.Merge().streams.AddListener(&streams);
+  pipeline.Start();
+
+  const std::uint64_t total = books.size() + prices.size();
+  const auto start = std::chrono::steady_clock::now();
+  std::size_t b = 0, p = 0;
+  while (b < books.size() || p < prices.size()) {
+    if (b < books.size()) pipeline.MarketDataInbound().OnMessage(books[b++]);
+    if (p < prices.size()) pipeline.PricingInbound().OnMessage(prices[p++]);
+  }
+  while (pipeline.Processed() < total) std::this_thread::yield();
+  pipeline.Stop();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  merged = executions.count + positions.count + risk.count + streams.count;
+  return static_cast<double>(total) / std::chrono::duration<double>(elapsed).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string md_file = argc > 1 ? argv[1] : "marketdata.txt";
+  const std::string px_file = argc > 2 ? argv[2] : "prices.txt";
+  const std::size_t max_shards = argc > 3 ? std::stoul(argv[3]) : 4;
+  const int rounds = argc > 4 ? std::stoi(argv[4]) : 3;
+
+  RegisterBondUniverse();
+  auto books = LoadBooks(md_file);
+  auto prices = LoadPrices(px_file);
+  std::cout << "books=" << books.size() << " prices=" << prices.size()
+            << " hardware_threads=" << std::thread::hardware_concurrency() << " (best of " << rounds << ")\n";
+
+  double base = 0;
+  for (std::size_t n = 1; n <= max_shards; ++n) {
+    double best = 0;
+    std::int64_t merged = 0;
+    for (int r = 0; r < rounds; ++r) {
+      const double rate = Run(n, books, prices, merged);
+      if (rate > best) best = rate;
+    }
+    if (n == 1) base = best;
+    std::cout << "shards=" << n << "  " << static_cast<long long>(best) << " msgs/sec  x" << best / base
+              << "  (merged " << merged << ")\n";
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BondMarketDataShmConnectors.hpp"
+
+// Measures the SHM rings: the fixed-slot ring in both modes and the variable-length
+// byte ring used for BOND_MD_SHM. One producer thread pushes messages, one consumer
+// thread reads them in place (Consume) through its own mapping. Two runs per ring:
+//   throughput = messages / wall time, producer pushing as fast as it can
+//   handoff latency = consumer read time - producer stamp time (steady_clock), with
+//                     one message in flight: the producer waits for each to be read
+//                     before stamping the next, so no time is spent queued behind
+//                     others (a flooded ring would mostly measure its own depth)
+//
+// Usage: ./shm_ring_bench [messages] [msg_bytes] [pingpong_messages]
+
+namespace {
+
+// Old BOND_MD_SHM slot sizing: 8192 slots x 2048 bytes = 16 MB.
+constexpr std::size_t kSlotCapacity = 8192;
+constexpr std::size_t kSlotMsgSize = 2048;
+
+std::int64_t NowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Queue, typename... CreateArgs>
+void RunThroughput(const char* label, long n, std::size_t msg_bytes, CreateArgs... create_args) {
+  const std::string shm_name = "BOND_MD_SHM_BENCH";
+
+  Queue producer(shm_name, /*create=*/true, create_args...);
+  Queue consumer(shm_name, /*create=*/false);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::thread t_consumer([&] {
+    for (long i = 0; i < n; ++i) consumer.Consume([](const char*, std::size_t) {});
+  });
+
+  const std::string msg(msg_bytes, 'x');
+  for (long i = 0; i < n; ++i) producer.Push(msg);
+
+  t_consumer.join();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  Queue::Remove(shm_name);
+
+  const double secs = std::chrono::duration<double>(elapsed).count();
+  std::cout << label << "  throughput  msgs/sec=" << static_cast<long long>(static_cast<double>(n) / secs) << "\n";
+}
+
+template <typename Queue, typename... CreateArgs>
+void RunHandoff(const char* label, long n, std::size_t msg_bytes, CreateArgs... create_args) {
+  const std::string shm_name = "BOND_MD_SHM_BENCH";
+
+  Queue producer(shm_name, /*create=*/true, create_args...);
+  Queue consumer(shm_name, /*create=*/false);
+
+  std::vector<std::int64_t> latency_ns(static_cast<std::size_t>(n));
+  std::atomic<long> read{0};
+
+  std::thread t_consumer([&] {
+    for (long i = 0; i < n; ++i) {
+      consumer.Consume([&](const char* data, std::size_t) {
+        std::int64_t sent = 0;
+        std::memcpy(&sent, data, sizeof(sent));
+        latency_ns[static_cast<std::size_t>(i)] = NowNs() - sent;
+      });
+      read.store(i + 1, std::memory_order_release);
+    }
+  });
+
+  std::string msg(msg_bytes, 'x');
+  for (long i = 0; i < n; ++i) {
+    SpinBackoff backoff;
+    while (read.load(std::memory_order_acquire) != i) backoff.Pause();
+    const std::int64_t ts = NowNs();
+    std::memcpy(&msg[0], &ts, sizeof(ts));
+    producer.Push(msg);
+  }
+
+  t_consumer.join();
+  Queue::Remove(shm_name);
+
+  std::sort(latency_ns.begin(), latency_ns.end());
+  auto pct = [&](double p) {
+    const auto idx = static_cast<std::size_t>(p * static_cast<double>(latency_ns.size() - 1));
+    return latency_ns[idx];
+  };
+
+  std::cout << label << "  handoff     p50=" << pct(0.50) << "ns"
+            << "  p99=" << pct(0.99) << "ns"
+            << "  max=" << latency_ns.back() << "ns\n";
+}
+
+template <typename Queue, typename... CreateArgs>
+void RunBench(const char* label, long n, long pingpong, std::size_t msg_bytes, CreateArgs... create_args) {
+  RunThroughput<Queue>(label, n, msg_bytes, create_args...);
+  RunHandoff<Queue>(label, pingpong, msg_bytes, create_args...);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  long n = 1000000;
+  std::size_t msg_bytes = 150;  // about one 5-level book line from gen_data
+
+  if (argc > 1) n = std::stol(argv[1]);
+  if (argc > 2) msg_bytes = static_cast<std::size_t>(std::stoul(argv[2]));
+  long pingpong = std::min(n, 100000L);  // a round trip each, so fewer by default
+  if (argc > 3) pingpong = std::stol(argv[3]);
+
+  if (n <= 0 || pingpong <= 0 || msg_bytes < sizeof(std::int64_t) || msg_bytes >= kSlotMsgSize) {
+    std::cerr << "Usage: shm_ring_bench [messages>0] [msg_bytes in 8.." << kSlotMsgSize - 1
+              << "] [pingpong_messages>0]\n";
+    return 1;
+  }
+
+  try {
+    RunBench<ShmQueueHandle<kSlotCapacity, kSlotMsgSize, ShmRingMode::kMutex>>("slot mutex", n, pingpong, msg_bytes);
+    RunBench<ShmQueueHandle<kSlotCapacity, kSlotMsgSize, ShmRingMode::kSpsc>>("slot spsc ", n, pingpong, msg_bytes);
+    RunBench<ShmByteRingHandle>("byte spsc ", n, pingpong, msg_bytes, kMdShmBytes);
+  } catch (const std::exception& e) {
+    std::cerr << "shm_ring_bench error: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
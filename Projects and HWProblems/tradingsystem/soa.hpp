@@ -8,6 +8,7 @@
 #ifndef SOA_HPP
 #define SOA_HPP
 
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -34,6 +35,83 @@ public:
 
 };
 
+/**
+ * Listener dispatch policies for Service implementations. A service notifies its
+ * listeners through one of these, chosen by template parameter:
+ *
+ * DynamicListeners<V>: the ServiceListener pointers registered with AddListener,
+ * called virtually. The default, and what GetListeners() returns.
+ *
+ * StaticListeners<V, Ls...>: a fixed set of listeners of known concrete type, bound
+ * at construction and called directly, so the compiler can inline a whole chain of
+ * services. Listeners added later with AddListener are still called (virtually),
+ * after the fixed ones.
+ */
+template<typename V>
+class DynamicListeners
+{
+public:
+  void Add(ServiceListener<V> *listener) { listeners.push_back(listener); }
+
+  const vector< ServiceListener<V>* >& Get() const { return listeners; }
+
+  // fn(listener) for each fixed listener; there are none
+  template<typename Fn>
+  void ForEachStatic(Fn &&) {}
+
+  // fn(listener) for every listener
+  template<typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    for (ServiceListener<V> *l : listeners)
+      if (l) fn(*l);
+  }
+
+private:
+  vector< ServiceListener<V>* > listeners;
+};
+
+template<typename V, typename... Ls>
+class StaticListeners : public DynamicListeners<V>
+{
+public:
+  explicit StaticListeners(Ls&... ls) : fixed(ls...) {}
+
+  template<typename Fn>
+  void ForEachStatic(Fn &&fn)
+  {
+    apply([&](auto&... l) { (fn(l), ...); }, fixed);
+  }
+
+  template<typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    ForEachStatic(fn);
+    DynamicListeners<V>::ForEach(fn);
+  }
+
+private:
+  tuple<Ls&...> fixed;
+};
+
+/**
+ * A ServiceListener that forwards every event to a fixed set of listeners by direct
+ * call, so several listeners can sit in one StaticListeners slot.
+ */
+template<typename V, typename... Ls>
+class FanoutListener final : public ServiceListener<V>
+{
+public:
+  explicit FanoutListener(Ls&... ls) : targets(ls...) {}
+
+  void ProcessAdd(V &data) override { apply([&](auto&... l) { (l.ProcessAdd(data), ...); }, targets); }
+  void ProcessRemove(V &data) override { apply([&](auto&... l) { (l.ProcessRemove(data), ...); }, targets); }
+  void ProcessUpdate(V &data) override { apply([&](auto&... l) { (l.ProcessUpdate(data), ...); }, targets); }
+
+private:
+  tuple<Ls&...> targets;
+};
+
 /**
  * Definition of a generic base class Service.
  * Uses key generic type K and value generic type V.
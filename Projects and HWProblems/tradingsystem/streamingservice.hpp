@@ -19,13 +19,13 @@ class PriceStreamOrder
 public:
 
   // ctor for an order
-  PriceStreamOrder(double _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side);
+  PriceStreamOrder(PriceTicks _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side);
 
   // The side on this order
   PricingSide GetSide() const;
 
   // Get the price on this order
-  double GetPrice() const;
+  PriceTicks GetPrice() const;
 
   // Get the visible quantity on this order
   long GetVisibleQuantity() const;
@@ -34,7 +34,7 @@ public:
   long GetHiddenQuantity() const;
 
 private:
-  double price;
+  PriceTicks price;
   long visibleQuantity;
   long hiddenQuantity;
   PricingSide side;
@@ -64,7 +64,7 @@ public:
   const PriceStreamOrder& GetOfferOrder() const;
 
 private:
-  T product;
+  const T* product;
   PriceStreamOrder bidOrder;
   PriceStreamOrder offerOrder;
 
@@ -86,7 +86,7 @@ public:
 
 };
 
-PriceStreamOrder::PriceStreamOrder(double _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side)
+PriceStreamOrder::PriceStreamOrder(PriceTicks _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side)
 {
   price = _price;
   visibleQuantity = _visibleQuantity;
@@ -94,7 +94,7 @@ PriceStreamOrder::PriceStreamOrder(double _price, long _visibleQuantity, long _h
   side = _side;
 }
 
-double PriceStreamOrder::GetPrice() const
+PriceTicks PriceStreamOrder::GetPrice() const
 {
   return price;
 }
@@ -111,14 +111,14 @@ long PriceStreamOrder::GetHiddenQuantity() const
 
 template<typename T>
 PriceStream<T>::PriceStream(const T &_product, const PriceStreamOrder &_bidOrder, const PriceStreamOrder &_offerOrder) :
-  product(_product), bidOrder(_bidOrder), offerOrder(_offerOrder)
+  product(&_product), bidOrder(_bidOrder), offerOrder(_offerOrder)
 {
 }
 
 template<typename T>
 const T& PriceStream<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
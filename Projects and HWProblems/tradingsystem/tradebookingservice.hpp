@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include "soa.hpp"
+#include "PriceTicks.hpp"
 
 // Trade sides
 enum Side { BUY, SELL };
@@ -25,7 +26,7 @@ class Trade
 public:
 
   // ctor for a trade
-  Trade(const T &_product, string _tradeId, double _price, string _book, long _quantity, Side _side);
+  Trade(const T &_product, string _tradeId, PriceTicks _price, string _book, long _quantity, Side _side);
 
   // Get the product
   const T& GetProduct() const;
@@ -34,7 +35,7 @@ public:
   const string& GetTradeId() const;
 
   // Get the mid price
-  double GetPrice() const;
+  PriceTicks GetPrice() const;
 
   // Get the book
   const string& GetBook() const;
@@ -46,9 +47,9 @@ public:
   Side GetSide() const;
 
 private:
-  T product;
+  const T* product;
   string tradeId;
-  double price;
+  PriceTicks price;
   string book;
   long quantity;
   Side side;
@@ -71,8 +72,8 @@ public:
 };
 
 template<typename T>
-Trade<T>::Trade(const T &_product, string _tradeId, double _price, string _book, long _quantity, Side _side) :
-  product(_product)
+Trade<T>::Trade(const T &_product, string _tradeId, PriceTicks _price, string _book, long _quantity, Side _side) :
+  product(&_product)
 {
   tradeId = _tradeId;
   price = _price;
@@ -84,7 +85,7 @@ Trade<T>::Trade(const T &_product, string _tradeId, double _price, string _book,
 template<typename T>
 const T& Trade<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -94,7 +95,7 @@ const string& Trade<T>::GetTradeId() const
 }
 
 template<typename T>
-double Trade<T>::GetPrice() const
+PriceTicks Trade<T>::GetPrice() const
 {
   return price;
 }